@@ -1,5 +1,6 @@
 #include <vector>
 #include <utility>
+#include <numeric>
 
 #include <cpp11/declarations.hpp>
 #include <cpp11/integers.hpp>
@@ -7,20 +8,43 @@
 #include <euclid.h>
 #include <polyclid.h>
 
+#include "coords.h"
+#include "inexact.h"
+#include "output.h"
+#include "parallel.h"
+#include "profile.h"
+
+// The point and vector types of the kernel an edge iterator belongs to
 template<typename Iter>
-std::vector<double> get_segment_lengths(Iter begin, Iter end) {
-  std::vector<double> res;
-  for (auto iter = begin; iter != end; iter++) {
-    res.push_back(CGAL::sqrt(CGAL::to_double(iter->squared_length().exact())));
+using Edge_point = typename std::decay<decltype(std::declval<Iter>()->source())>::type;
+template<typename Iter>
+using Edge_vector = typename CGAL::Kernel_traits< Edge_point<Iter> >::Kernel::Vector_2;
+
+// Adds `n` evenly spaced points along an edge, excluding its end points. Each
+// point is constructed directly from the source of the edge rather than from
+// the previous point so lazy exact points never form long dependency chains
+template<typename Iter>
+void insert_edge_points(Iter edge, unsigned int n, std::vector< Edge_point<Iter> >& res) {
+  typedef typename CGAL::Kernel_traits< Edge_point<Iter> >::Kernel::FT FT;
+  if (n == 0) return;
+  Edge_point<Iter> source = edge->source();
+  Edge_vector<Iter> vec(*edge);
+  FT denom(n + 1);
+  for (unsigned int k = 1; k <= n; ++k) {
+    res.push_back(source + vec * (FT(k) / denom));
   }
-  return res;
 }
 
 template<typename Iter>
-std::vector<Point_2> insert_vert_to_c(Iter begin, Iter end, unsigned int n,
+std::vector<double> get_segment_lengths(Iter begin, Iter end) {
+  return edge_lengths(extract_edge_coords(begin, end), false);
+}
+
+template<typename Iter>
+std::vector< Edge_point<Iter> > insert_vert_to_c(Iter begin, Iter end, unsigned int n,
                                       std::vector<double>& lengths,
                                       double total, bool wrap) {
-  std::vector<Point_2> res;
+  std::vector< Edge_point<Iter> > res;
   unsigned int cur_n = 0;
   for (auto iter = begin; iter != end; iter++) {
     cur_n++;
@@ -56,31 +80,21 @@ std::vector<Point_2> insert_vert_to_c(Iter begin, Iter end, unsigned int n,
   size_t i = 0;
   for (auto iter = begin; iter != end; iter++) {
     res.push_back(iter->source());
-    unsigned int n_splits = splits[i];
+    insert_edge_points(iter, splits[i], res);
     i++;
-    if (n_splits == 0) continue;
-    Vector_2 vec(*iter);
-    vec /= n_splits + 1;
-    while (n_splits--) {
-      res.push_back(res.back() + vec);
-    }
   }
   if (!wrap) res.push_back(std::prev(end, 1)->target());
   return res;
 }
 
 template<typename Iter>
-std::vector<Point_2> insert_vert_to_l(Iter begin, Iter end, double max_l, bool wrap) {
-  std::vector<Point_2> res;
+std::vector< Edge_point<Iter> > insert_vert_to_l(Iter begin, Iter end, double max_l, bool wrap) {
+  std::vector< Edge_point<Iter> > res;
+  std::vector<double> lengths = get_segment_lengths(begin, end);
+  size_t i = 0;
   for (auto iter = begin; iter != end; iter++) {
     res.push_back(iter->source());
-    Vector_2 vec(*iter);
-    double l_seg = CGAL::sqrt(CGAL::to_double(vec.squared_length().exact()));
-    unsigned int n = std::floor(l_seg / max_l);
-    vec /= n + 1;
-    while (n--) {
-      res.push_back(res.back() + vec);
-    }
+    insert_edge_points(iter, std::floor(lengths[i++] / max_l), res);
   }
   if (!wrap) {
     res.push_back(std::prev(end, 1)->target());
@@ -89,16 +103,46 @@ std::vector<Point_2> insert_vert_to_l(Iter begin, Iter end, double max_l, bool w
 }
 
 template<typename Iter>
-std::vector<Point_2> insert_vert_to_n(Iter begin, Iter end, unsigned int n, bool wrap) {
-  std::vector<Point_2> res;
+std::vector< Edge_point<Iter> > insert_vert_to_n(Iter begin, Iter end, unsigned int n, bool wrap) {
+  std::vector< Edge_point<Iter> > res;
   for (auto iter = begin; iter != end; iter++) {
     res.push_back(iter->source());
-    Vector_2 vec(*iter);
-    vec /= n + 1;
-    unsigned int n_temp = n;
-    while (n_temp--) {
-      res.push_back(res.back() + vec);
-    }
+    insert_edge_points(iter, n, res);
+  }
+  if (!wrap) {
+    res.push_back(std::prev(end, 1)->target());
+  }
+  return res;
+}
+
+// Splits the edges into chunks that are densified in parallel with `insert`
+// and concatenated. The result is identical to calling `insert` on the full
+// range
+template<typename Iter, typename F>
+std::vector< Edge_point<Iter> > insert_vert_chunked(Iter begin, Iter end, bool wrap, F insert) {
+  size_t n_edges = std::distance(begin, end);
+  size_t n_chunks = (n_edges + RING_CHUNK_SIZE - 1) / RING_CHUNK_SIZE;
+  if (n_chunks < 2 || get_thread_count() < 2 || in_parallel_region()) {
+    return insert(begin, end, wrap);
+  }
+  std::vector<Iter> bounds;
+  bounds.reserve(n_chunks + 1);
+  for (size_t i = 0; i < n_chunks; ++i) {
+    bounds.push_back(std::next(begin, i * RING_CHUNK_SIZE));
+  }
+  bounds.push_back(end);
+
+  std::vector< std::vector< Edge_point<Iter> > > chunks(n_chunks);
+  parallel_for(n_chunks, [&](size_t i) {
+    chunks[i] = insert(bounds[i], bounds[i + 1], true);
+  });
+
+  std::vector< Edge_point<Iter> > res;
+  size_t total = 0;
+  for (auto& chunk : chunks) total += chunk.size();
+  res.reserve(total + 1);
+  for (auto& chunk : chunks) {
+    res.insert(res.end(), chunk.begin(), chunk.end());
   }
   if (!wrap) {
     res.push_back(std::prev(end, 1)->target());
@@ -106,103 +150,160 @@ std::vector<Point_2> insert_vert_to_n(Iter begin, Iter end, unsigned int n, bool
   return res;
 }
 
+template<typename Iter>
+std::vector< Edge_point<Iter> > insert_vert_to_l_chunked(Iter begin, Iter end, double max_l, bool wrap) {
+  return insert_vert_chunked(begin, end, wrap, [max_l](Iter b, Iter e, bool w) {
+    return insert_vert_to_l(b, e, max_l, w);
+  });
+}
+
+template<typename Iter>
+std::vector< Edge_point<Iter> > insert_vert_to_n_chunked(Iter begin, Iter end, unsigned int n, bool wrap) {
+  return insert_vert_chunked(begin, end, wrap, [n](Iter b, Iter e, bool w) {
+    return insert_vert_to_n(b, e, n, w);
+  });
+}
+
+template<typename Iter>
+std::vector< Edge_point<Iter> > add_detail_line(Iter begin, Iter end, int c, double l, int n, bool use_l, bool use_n) {
+  if (use_l) {
+    return insert_vert_to_l_chunked(begin, end, l, false);
+  }
+  if (use_n) {
+    return insert_vert_to_n_chunked(begin, end, n, false);
+  }
+  std::vector<double> lengths = get_segment_lengths(begin, end);
+  double full_length = std::accumulate(lengths.begin(), lengths.end(), 0.0);
+  return insert_vert_to_c(begin, end, c, lengths, full_length, false);
+}
+
+template<typename PWH>
+PWH add_detail_polygon(const PWH& poly, int c, double l, int n, bool use_l, bool use_n) {
+  typedef typename PWH::Polygon_2 Ring;
+  std::vector< typename Ring::Point_2 > line;
+  PWH p;
+  if (use_l) {
+    if (!poly.is_unbounded()) {
+      line = insert_vert_to_l_chunked(poly.outer_boundary().edges_begin(), poly.outer_boundary().edges_end(), l, true);
+      p = PWH(Ring(line.begin(), line.end()));
+    }
+    for (auto h_iter = poly.holes_begin(); h_iter != poly.holes_end(); h_iter++) {
+      line = insert_vert_to_l_chunked(h_iter->edges_begin(), h_iter->edges_end(), l, true);
+      p.add_hole(Ring(line.begin(), line.end()));
+    }
+  } else if (use_n) {
+    if (!poly.is_unbounded()) {
+      line = insert_vert_to_n_chunked(poly.outer_boundary().edges_begin(), poly.outer_boundary().edges_end(), n, true);
+      p = PWH(Ring(line.begin(), line.end()));
+    }
+    for (auto h_iter = poly.holes_begin(); h_iter != poly.holes_end(); h_iter++) {
+      line = insert_vert_to_n_chunked(h_iter->edges_begin(), h_iter->edges_end(), n, true);
+      p.add_hole(Ring(line.begin(), line.end()));
+    }
+  } else {
+    std::vector< std::vector<double> > lengths;
+    std::vector<double> full_lengths;
+    if (!poly.is_unbounded()) {
+      lengths.push_back(get_segment_lengths(poly.outer_boundary().edges_begin(), poly.outer_boundary().edges_end()));
+      full_lengths.push_back(std::accumulate(lengths.back().begin(), lengths.back().end(), 0.0));
+    }
+    for (auto h_iter = poly.holes_begin(); h_iter != poly.holes_end(); h_iter++) {
+      lengths.push_back(get_segment_lengths(h_iter->edges_begin(), h_iter->edges_end()));
+      full_lengths.push_back(std::accumulate(lengths.back().begin(), lengths.back().end(), 0.0));
+    }
+    std::vector<double> mean_length;
+    for (size_t j = 0; j < full_lengths.size(); ++j) {
+      mean_length.push_back(full_lengths[j] / lengths[j].size());
+    }
+    double summed_mean = std::accumulate(mean_length.begin(), mean_length.end(), 0.0);
+    std::vector<unsigned> ns;
+    for (size_t j = 0; j < mean_length.size() - 1; ++j) {
+      ns.push_back(std::round(c * mean_length[j] / summed_mean));
+    }
+    ns.push_back(c - std::accumulate(ns.begin(), ns.end(), 0));
+    size_t h = 0;
+    if (!poly.is_unbounded()) {
+      line = insert_vert_to_c(poly.outer_boundary().edges_begin(), poly.outer_boundary().edges_end(),
+                              ns[h], lengths[h], full_lengths[h], true);
+      p = PWH(Ring(line.begin(), line.end()));
+      h++;
+    }
+    for (auto h_iter = poly.holes_begin(); h_iter != poly.holes_end(); h_iter++) {
+      line = insert_vert_to_c(h_iter->edges_begin(), h_iter->edges_end(),
+                              ns[h], lengths[h], full_lengths[h], true);
+      p.add_hole(Ring(line.begin(), line.end()));
+      h++;
+    }
+  }
+  return p;
+}
+
 [[cpp11::register]]
-SEXP poly_add_detail(SEXP poly, cpp11::integers c, cpp11::doubles l, cpp11::integers n, bool use_l, bool use_n) {
+SEXP poly_add_detail(SEXP poly, cpp11::integers c, cpp11::doubles l, cpp11::integers n, bool use_l, bool use_n, bool fast) {
+  std::vector<int> c_vec(c.begin(), c.end());
+  std::vector<double> l_vec(l.begin(), l.end());
+  std::vector<int> n_vec(n.begin(), n.end());
+  Profile_scope profile("poly_add_detail");
+  Phase_timer input(PHASE_INPUT);
   switch (polyclid::get_geometry_type(poly)) {
     case polyclid::POLYLINE: {
       std::vector<Polyline> lines = polyclid::get_polyline_vec(poly);
-      std::vector<Polyline> res;
-      res.reserve(lines.size());
-      for (size_t i = 0; i < lines.size(); ++i) {
+      input.stop(lines.size());
+      std::vector<Polyline> res(lines.size());
+      parallel_for(lines.size(), [&](size_t i) {
         if (lines[i].is_na() || lines[i].is_empty()) {
-          res.push_back(lines[i]);
-          continue;
+          res[i] = std::move(lines[i]);
+          return;
         }
-        std::vector<Point_2> line;
-        if (use_l) {
-          line = insert_vert_to_l(lines[i].edges_begin(), lines[i].edges_end(), l[i%l.size()], false);
-        } else if (use_n) {
-          line = insert_vert_to_n(lines[i].edges_begin(), lines[i].edges_end(), n[i%n.size()], false);
+        int c_i = c_vec[i%c_vec.size()];
+        double l_i = l_vec[i%l_vec.size()];
+        int n_i = n_vec[i%n_vec.size()];
+        if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          std::vector<I_Kernel::Segment_2> edges = inexact_edges(exact_to_inexact_line(lines[i]));
+          timer.next(PHASE_ALGORITHM);
+          std::vector<I_Kernel::Point_2> line = add_detail_line(edges.begin(), edges.end(), c_i, l_i, n_i, use_l, use_n);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_line(line);
         } else {
-          std::vector<double> lengths = get_segment_lengths(lines[i].edges_begin(), lines[i].edges_end());
-          double full_length = std::accumulate(lengths.begin(), lengths.end(), 0.0);
-          line = insert_vert_to_c(lines[i].edges_begin(), lines[i].edges_end(),
-                                  c[i%c.size()], lengths, full_length, false);
+          Phase_timer timer(PHASE_ALGORITHM);
+          std::vector<Point_2> line = add_detail_line(lines[i].edges_begin(), lines[i].edges_end(), c_i, l_i, n_i, use_l, use_n);
+          res[i] = Polyline(line.begin(), line.end());
         }
-        res.emplace_back(line.begin(), line.end());
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
       return polyclid::create_polyline_vec(res);
     }
     case polyclid::POLYGON: {
       std::vector<Polygon> polygons = polyclid::get_polygon_vec(poly);
-      std::vector<Polygon> res;
-      res.reserve(polygons.size());
-      for (size_t i = 0; i < polygons.size(); ++i) {
+      input.stop(polygons.size());
+      std::vector<Polygon> res(polygons.size());
+      parallel_for(polygons.size(), [&](size_t i) {
         if (polygons[i].is_na() || (polygons[i].is_unbounded() && polygons[i].number_of_holes() == 0)) {
-          res.push_back(polygons[i]);
-          continue;
+          res[i] = std::move(polygons[i]);
+          return;
         }
-        std::vector<Point_2> line;
-        Polygon p;
-        if (use_l) {
-          if (!polygons[i].is_unbounded()) {
-            line = insert_vert_to_l(polygons[i].outer_boundary().edges_begin(), polygons[i].outer_boundary().edges_end(), l[i%l.size()], true);
-            p = Polygon(Segment_trait::Polygon_2(line.begin(), line.end()));
-          }
-          for (auto h_iter = polygons[i].holes_begin(); h_iter != polygons[i].holes_end(); h_iter++) {
-            line = insert_vert_to_l(h_iter->edges_begin(), h_iter->edges_end(), l[i%l.size()], true);
-            p.add_hole(Segment_trait::Polygon_2(line.begin(), line.end()));
-          }
-        } else if (use_n) {
-          if (!polygons[i].is_unbounded()) {
-            line = insert_vert_to_n(polygons[i].outer_boundary().edges_begin(), polygons[i].outer_boundary().edges_end(), n[i%n.size()], true);
-            p = Polygon(Segment_trait::Polygon_2(line.begin(), line.end()));
-          }
-          for (auto h_iter = polygons[i].holes_begin(); h_iter != polygons[i].holes_end(); h_iter++) {
-            line = insert_vert_to_n(h_iter->edges_begin(), h_iter->edges_end(), n[i%n.size()], true);
-            p.add_hole(Segment_trait::Polygon_2(line.begin(), line.end()));
-          }
+        int c_i = c_vec[i%c_vec.size()];
+        double l_i = l_vec[i%l_vec.size()];
+        int n_i = n_vec[i%n_vec.size()];
+        if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          I_Polygon ipoly = exact_to_inexact_poly(polygons[i]);
+          timer.next(PHASE_ALGORITHM);
+          ipoly = add_detail_polygon(ipoly, c_i, l_i, n_i, use_l, use_n);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_poly(ipoly);
         } else {
-          std::vector< std::vector<double> > lengths;
-          std::vector<double> full_lengths;
-          if (!polygons[i].is_unbounded()) {
-            lengths.push_back(get_segment_lengths(polygons[i].outer_boundary().edges_begin(), polygons[i].outer_boundary().edges_end()));
-            full_lengths.push_back(std::accumulate(lengths.back().begin(), lengths.back().end(), 0.0));
-          }
-          for (auto h_iter = polygons[i].holes_begin(); h_iter != polygons[i].holes_end(); h_iter++) {
-            lengths.push_back(get_segment_lengths(h_iter->edges_begin(), h_iter->edges_end()));
-            full_lengths.push_back(std::accumulate(lengths.back().begin(), lengths.back().end(), 0.0));
-          }
-          std::vector<double> mean_length;
-          for (size_t j = 0; j < full_lengths.size(); ++j) {
-            mean_length.push_back(full_lengths[j] / lengths[j].size());
-          }
-          double summed_mean = std::accumulate(mean_length.begin(), mean_length.end(), 0.0);
-          std::vector<unsigned> ns;
-          for (size_t j = 0; j < mean_length.size() - 1; ++j) {
-            ns.push_back(std::round(c[i%c.size()] * mean_length[j] / summed_mean));
-          }
-          ns.push_back(c[i%c.size()] - std::accumulate(ns.begin(), ns.end(), 0));
-          size_t h = 0;
-          if (!polygons[i].is_unbounded()) {
-            line = insert_vert_to_c(polygons[i].outer_boundary().edges_begin(), polygons[i].outer_boundary().edges_end(),
-                                    ns[h], lengths[h], full_lengths[h], true);
-            p = Polygon(Segment_trait::Polygon_2(line.begin(), line.end()));
-            h++;
-          }
-          for (auto h_iter = polygons[i].holes_begin(); h_iter != polygons[i].holes_end(); h_iter++) {
-            line = insert_vert_to_c(h_iter->edges_begin(), h_iter->edges_end(),
-                                    ns[h], lengths[h], full_lengths[h], true);
-            p.add_hole(Segment_trait::Polygon_2(line.begin(), line.end()));
-            h++;
-          }
+          Phase_timer timer(PHASE_ALGORITHM);
+          res[i] = add_detail_polygon(polygons[i], c_i, l_i, n_i, use_l, use_n);
         }
-        res.push_back(p);
-        return polyclid::create_polygon_vec(res);
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
+      return polyclid::create_polygon_vec(res);
     }
     default: cpp11::stop("Unknown geometry type");
   }
   return R_NilValue;
 }
-
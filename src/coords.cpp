@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+
+#include "coords.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOUNDARIES_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+// The kernels below work on offset views into the coordinate arrays so the
+// same code handles rings and lines. The vectorised versions process the bulk
+// of the data and hand the remainder to the scalar version. The vectorised
+// versions do not use fused multiply-add, but the compiler may contract the
+// scalar arithmetic into it, so results can differ in the last bits between
+// the versions and thus with the length of the ring
+
+static void edge_length_scalar(const double* x0, const double* y0,
+                               const double* x1, const double* y1,
+                               size_t n, double* out) {
+  for (size_t i = 0; i < n; ++i) {
+    double dx = x1[i] - x0[i];
+    double dy = y1[i] - y0[i];
+    out[i] = std::sqrt(dx * dx + dy * dy);
+  }
+}
+
+// Calculates |a - b| and |a + b| where a is the incoming edge scaled by the
+// length of the outgoing edge and b is the outgoing edge scaled by the length
+// of the incoming edge
+static void turning_scalar(const double* xp, const double* yp,
+                           const double* xc, const double* yc,
+                           const double* xn, const double* yn,
+                           const double* l_in, const double* l_out,
+                           size_t n, double* diff, double* sum) {
+  for (size_t i = 0; i < n; ++i) {
+    double ax = (xc[i] - xp[i]) * l_out[i];
+    double ay = (yc[i] - yp[i]) * l_out[i];
+    double bx = (xn[i] - xc[i]) * l_in[i];
+    double by = (yn[i] - yc[i]) * l_in[i];
+    double dx = ax - bx, dy = ay - by;
+    double sx = ax + bx, sy = ay + by;
+    diff[i] = std::sqrt(dx * dx + dy * dy);
+    sum[i] = std::sqrt(sx * sx + sy * sy);
+  }
+}
+
+#ifdef BOUNDARIES_SIMD_DISPATCH
+
+__attribute__((target("sse2")))
+static void edge_length_sse2(const double* x0, const double* y0,
+                             const double* x1, const double* y1,
+                             size_t n, double* out) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(x1 + i), _mm_loadu_pd(x0 + i));
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(y1 + i), _mm_loadu_pd(y0 + i));
+    __m128d len2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+    _mm_storeu_pd(out + i, _mm_sqrt_pd(len2));
+  }
+  edge_length_scalar(x0 + i, y0 + i, x1 + i, y1 + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+static void edge_length_avx2(const double* x0, const double* y0,
+                             const double* x1, const double* y1,
+                             size_t n, double* out) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x1 + i), _mm256_loadu_pd(x0 + i));
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y1 + i), _mm256_loadu_pd(y0 + i));
+    __m256d len2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+    _mm256_storeu_pd(out + i, _mm256_sqrt_pd(len2));
+  }
+  edge_length_scalar(x0 + i, y0 + i, x1 + i, y1 + i, n - i, out + i);
+}
+
+__attribute__((target("sse2")))
+static void turning_sse2(const double* xp, const double* yp,
+                         const double* xc, const double* yc,
+                         const double* xn, const double* yn,
+                         const double* l_in, const double* l_out,
+                         size_t n, double* diff, double* sum) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d px = _mm_loadu_pd(xp + i), py = _mm_loadu_pd(yp + i);
+    __m128d cx = _mm_loadu_pd(xc + i), cy = _mm_loadu_pd(yc + i);
+    __m128d nx = _mm_loadu_pd(xn + i), ny = _mm_loadu_pd(yn + i);
+    __m128d li = _mm_loadu_pd(l_in + i), lo = _mm_loadu_pd(l_out + i);
+    __m128d ax = _mm_mul_pd(_mm_sub_pd(cx, px), lo);
+    __m128d ay = _mm_mul_pd(_mm_sub_pd(cy, py), lo);
+    __m128d bx = _mm_mul_pd(_mm_sub_pd(nx, cx), li);
+    __m128d by = _mm_mul_pd(_mm_sub_pd(ny, cy), li);
+    __m128d dx = _mm_sub_pd(ax, bx), dy = _mm_sub_pd(ay, by);
+    __m128d sx = _mm_add_pd(ax, bx), sy = _mm_add_pd(ay, by);
+    _mm_storeu_pd(diff + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    _mm_storeu_pd(sum + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(sx, sx), _mm_mul_pd(sy, sy))));
+  }
+  turning_scalar(xp + i, yp + i, xc + i, yc + i, xn + i, yn + i, l_in + i, l_out + i, n - i, diff + i, sum + i);
+}
+
+__attribute__((target("avx2")))
+static void turning_avx2(const double* xp, const double* yp,
+                         const double* xc, const double* yc,
+                         const double* xn, const double* yn,
+                         const double* l_in, const double* l_out,
+                         size_t n, double* diff, double* sum) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d px = _mm256_loadu_pd(xp + i), py = _mm256_loadu_pd(yp + i);
+    __m256d cx = _mm256_loadu_pd(xc + i), cy = _mm256_loadu_pd(yc + i);
+    __m256d nx = _mm256_loadu_pd(xn + i), ny = _mm256_loadu_pd(yn + i);
+    __m256d li = _mm256_loadu_pd(l_in + i), lo = _mm256_loadu_pd(l_out + i);
+    __m256d ax = _mm256_mul_pd(_mm256_sub_pd(cx, px), lo);
+    __m256d ay = _mm256_mul_pd(_mm256_sub_pd(cy, py), lo);
+    __m256d bx = _mm256_mul_pd(_mm256_sub_pd(nx, cx), li);
+    __m256d by = _mm256_mul_pd(_mm256_sub_pd(ny, cy), li);
+    __m256d dx = _mm256_sub_pd(ax, bx), dy = _mm256_sub_pd(ay, by);
+    __m256d sx = _mm256_add_pd(ax, bx), sy = _mm256_add_pd(ay, by);
+    _mm256_storeu_pd(diff + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    _mm256_storeu_pd(sum + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(sx, sx), _mm256_mul_pd(sy, sy))));
+  }
+  turning_scalar(xp + i, yp + i, xc + i, yc + i, xn + i, yn + i, l_in + i, l_out + i, n - i, diff + i, sum + i);
+}
+
+#endif
+
+typedef void (*Edge_length_kernel)(const double*, const double*, const double*, const double*, size_t, double*);
+typedef void (*Turning_kernel)(const double*, const double*, const double*, const double*, const double*,
+                               const double*, const double*, const double*, size_t, double*, double*);
+
+// Pick the widest instruction set supported by the running CPU. This is
+// decided once so the check does not add to every call
+static Edge_length_kernel edge_length_kernel() {
+#ifdef BOUNDARIES_SIMD_DISPATCH
+  static const Edge_length_kernel kernel = __builtin_cpu_supports("avx2") ? edge_length_avx2 :
+    (__builtin_cpu_supports("sse2") ? edge_length_sse2 : edge_length_scalar);
+  return kernel;
+#else
+  return edge_length_scalar;
+#endif
+}
+
+static Turning_kernel turning_kernel() {
+#ifdef BOUNDARIES_SIMD_DISPATCH
+  static const Turning_kernel kernel = __builtin_cpu_supports("avx2") ? turning_avx2 :
+    (__builtin_cpu_supports("sse2") ? turning_sse2 : turning_scalar);
+  return kernel;
+#else
+  return turning_scalar;
+#endif
+}
+
+std::vector<double> edge_lengths(const Coords& coords, bool wrap) {
+  size_t n = coords.size();
+  if (n < 2) {
+    return std::vector<double>(wrap ? n : 0, 0.0);
+  }
+  std::vector<double> res(wrap ? n : n - 1);
+  const double* x = coords.x.data();
+  const double* y = coords.y.data();
+  // Each chunk reads one vertex beyond its last edge
+  Edge_length_kernel kernel = edge_length_kernel();
+  size_t n_chunks = (n - 1 + RING_CHUNK_SIZE - 1) / RING_CHUNK_SIZE;
+  parallel_for(n_chunks, [&](size_t c) {
+    size_t start = c * RING_CHUNK_SIZE;
+    size_t end = std::min(start + RING_CHUNK_SIZE, n - 1);
+    kernel(x + start, y + start, x + start + 1, y + start + 1, end - start, res.data() + start);
+  });
+  if (wrap) {
+    edge_length_scalar(x + n - 1, y + n - 1, x, y, 1, res.data() + n - 1);
+  }
+  return res;
+}
+
+std::vector<double> turning_angles(const Coords& coords, const std::vector<double>& lengths, bool wrap) {
+  const double pi = 3.14159265359;
+  size_t n = coords.size();
+  std::vector<double> res(n, pi);
+  if (n < 3) {
+    return res;
+  }
+  const double* x = coords.x.data();
+  const double* y = coords.y.data();
+  const double* l = lengths.data();
+  std::vector<double> diff(n), sum(n);
+  // Chunks cover the vertices with both neighbours in the array, i.e. 1 to
+  // n - 2, and read one vertex on either side of them
+  Turning_kernel kernel = turning_kernel();
+  size_t n_chunks = (n - 2 + RING_CHUNK_SIZE - 1) / RING_CHUNK_SIZE;
+  parallel_for(n_chunks, [&](size_t c) {
+    size_t start = c * RING_CHUNK_SIZE;
+    size_t end = std::min(start + RING_CHUNK_SIZE, n - 2);
+    kernel(x + start, y + start, x + start + 1, y + start + 1, x + start + 2, y + start + 2,
+           l + start, l + start + 1, end - start, diff.data() + start + 1, sum.data() + start + 1);
+    for (size_t i = start + 1; i <= end; ++i) {
+      res[i] = pi - std::atan2(diff[i], sum[i]);
+    }
+  });
+  if (wrap) {
+    // The first and last vertex are surrounded by the closing edge
+    double xp[2] = {x[n - 1], x[n - 2]}, yp[2] = {y[n - 1], y[n - 2]};
+    double xc[2] = {x[0], x[n - 1]}, yc[2] = {y[0], y[n - 1]};
+    double xn[2] = {x[1], x[0]}, yn[2] = {y[1], y[0]};
+    double l_in[2] = {l[n - 1], l[n - 2]}, l_out[2] = {l[0], l[n - 1]};
+    double d[2], s[2];
+    turning_scalar(xp, yp, xc, yc, xn, yn, l_in, l_out, 2, d, s);
+    res[0] = pi - std::atan2(d[0], s[0]);
+    res[n - 1] = pi - std::atan2(d[1], s[1]);
+  }
+  return res;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+
+#include <CGAL/number_utils.h>
+
+#include "parallel.h"
+
+// The coordinates of a ring or line stored as two contiguous arrays of
+// doubles so edge measures can be calculated in bulk. Coordinates are read
+// with to_double(), which uses the approximation of lazy numbers and only
+// evaluates them exactly if the approximation is not precise enough
+struct Coords {
+  std::vector<double> x;
+  std::vector<double> y;
+
+  Coords() {}
+  Coords(size_t n) : x(n), y(n) {}
+
+  size_t size() const { return x.size(); }
+};
+
+// Extract the coordinates of a random access point container (e.g. a
+// Polygon_2 or a vector of points)
+template<typename Points>
+Coords extract_coords(const Points& points) {
+  Coords res(points.size());
+  parallel_for(points.size(), [&](size_t i) {
+    res.x[i] = CGAL::to_double(points[i].x());
+    res.y[i] = CGAL::to_double(points[i].y());
+  }, RING_CHUNK_SIZE);
+  return res;
+}
+
+// Extract the coordinates of the vertices along a range of edges, i.e. the
+// source of every edge followed by the target of the last one
+template<typename Iter>
+Coords extract_edge_coords(Iter begin, Iter end) {
+  Coords res;
+  for (auto iter = begin; iter != end; iter++) {
+    res.x.push_back(CGAL::to_double(iter->source().x()));
+    res.y.push_back(CGAL::to_double(iter->source().y()));
+  }
+  if (begin != end) {
+    auto last = std::prev(end, 1)->target();
+    res.x.push_back(CGAL::to_double(last.x()));
+    res.y.push_back(CGAL::to_double(last.y()));
+  }
+  return res;
+}
+
+// The length of the edge following each vertex. If `wrap` the edge closing the
+// ring is included so there is one length per vertex, otherwise there is one
+// less. Long rings and lines are split into chunks of RING_CHUNK_SIZE edges
+// that are handled on separate threads
+std::vector<double> edge_lengths(const Coords& coords, bool wrap);
+
+// The corner measure used by corner clipping at each vertex given the edge
+// lengths from edge_lengths(): pi minus half the angle between the incoming and
+// outgoing edge, so a straight continuation gives pi. If not `wrap` the end
+// points get a value of pi. Split into chunks like edge_lengths()
+std::vector<double> turning_angles(const Coords& coords, const std::vector<double>& lengths, bool wrap);
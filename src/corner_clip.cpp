@@ -7,239 +7,491 @@
 #include <euclid.h>
 #include <polyclid.h>
 
-#include <list>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
+#include "coords.h"
+#include "inexact.h"
+#include "output.h"
+#include "parallel.h"
+#include "profile.h"
+
+template<typename K>
 struct Edge {
-  Point_2 source;
+  typename K::Point_2 source;
   double length;
   bool corner;
   double cut_dist_back;
   double cut_dist_forward;
 };
 
-std::vector<Point_2> cut_corners(std::list<Edge>& edges, size_t n_cut, bool wrap) {
+static const size_t NO_EDGE = std::numeric_limits<size_t>::max();
+
+// The edges of a ring or line stored in a flat array and linked by index. New
+// edges are appended to the array and removed edges are only unlinked so that
+// cutting a corner never allocates per edge. After each pass the edges are
+// copied in order to a second array which is used for the next pass
+template<typename K>
+struct Edge_chain {
+  std::vector< Edge<K> > edges;
+  std::vector<size_t> prev;
+  std::vector<size_t> next;
+  size_t first = NO_EDGE;
+  size_t last = NO_EDGE;
+  size_t n_edges = 0;
+
+  void clear() {
+    edges.clear();
+    prev.clear();
+    next.clear();
+    first = NO_EDGE;
+    last = NO_EDGE;
+    n_edges = 0;
+  }
+  void reserve(size_t n) {
+    edges.reserve(n);
+    prev.reserve(n);
+    next.reserve(n);
+  }
+  void push_back(const Edge<K>& edge) {
+    size_t i = edges.size();
+    edges.push_back(edge);
+    prev.push_back(last);
+    next.push_back(NO_EDGE);
+    if (last == NO_EDGE) first = i;
+    else next[last] = i;
+    last = i;
+    n_edges++;
+  }
+  size_t insert_after(size_t pos, const Edge<K>& edge) {
+    size_t i = edges.size();
+    size_t after = next[pos];
+    edges.push_back(edge);
+    prev.push_back(pos);
+    next.push_back(after);
+    if (after == NO_EDGE) last = i;
+    else prev[after] = i;
+    next[pos] = i;
+    n_edges++;
+    return i;
+  }
+  void erase(size_t i) {
+    size_t before = prev[i], after = next[i];
+    if (before == NO_EDGE) first = after;
+    else next[before] = after;
+    if (after == NO_EDGE) last = before;
+    else prev[after] = before;
+    n_edges--;
+  }
+  // Every pass adds at most one edge per existing edge
+  void compact_to(Edge_chain& other) const {
+    other.clear();
+    other.reserve(n_edges * 2);
+    for (size_t i = first; i != NO_EDGE; i = next[i]) {
+      other.push_back(edges[i]);
+    }
+  }
+};
+
+template<typename K>
+std::vector<typename K::Point_2> cut_corners(Edge_chain<K>& edges, size_t n_cut, bool wrap) {
+  typedef typename K::Point_2 Point;
+  typedef typename K::Vector_2 Vector;
+  std::vector< Edge<K> >& e = edges.edges;
+  Edge_chain<K> buffer;
   while (n_cut != 0) {
-    auto iter = edges.begin();
-    while (iter != edges.end()) {
-      if (!iter->corner) {
-        iter++;
+    size_t iter = edges.first;
+    while (iter != NO_EDGE) {
+      if (!e[iter].corner) {
+        iter = edges.next[iter];
         continue;
       }
-      auto next_corner = std::next(iter, 1);
-      while (next_corner != edges.end()) {
-        if (next_corner->corner) break;
-        next_corner++;
+      size_t next_corner = edges.next[iter];
+      while (next_corner != NO_EDGE) {
+        if (e[next_corner].corner) break;
+        next_corner = edges.next[next_corner];
       }
-      auto back_iter = std::prev(iter == edges.begin() ? edges.end() : iter, 1);
+      double cut_dist_back = e[iter].cut_dist_back;
+      double cut_dist_forward = e[iter].cut_dist_forward;
+      size_t back_iter = iter == edges.first ? edges.last : edges.prev[iter];
       double len = 0.0;
-      while (len + back_iter->length <= iter->cut_dist_back) {
-        len += back_iter->length;
-        if (back_iter == edges.begin()) {
+      while (len + e[back_iter].length <= cut_dist_back) {
+        len += e[back_iter].length;
+        if (back_iter == edges.first) {
           if (!wrap) break;
-          back_iter = edges.end();
+          back_iter = edges.last;
+        } else {
+          back_iter = edges.prev[back_iter];
         }
-        back_iter--;
       }
-      double length_reduction = 1.0 - (iter->cut_dist_back - len) / back_iter->length;
-      auto beyond = std::next(back_iter, 1);
-      if (wrap && beyond == edges.end()) beyond = edges.begin();
-      Point_2 new_source = back_iter->source + Vector_2(back_iter->source, beyond->source) * Kernel::FT(length_reduction);
-      back_iter->length *= length_reduction;
+      double length_reduction = 1.0 - (cut_dist_back - len) / e[back_iter].length;
+      size_t beyond = edges.next[back_iter];
+      if (wrap && beyond == NO_EDGE) beyond = edges.first;
+      Point new_source = e[back_iter].source + Vector(e[back_iter].source, e[beyond].source) * typename K::FT(length_reduction);
+      e[back_iter].length *= length_reduction;
 
-      auto front_iter = iter;
+      size_t front_iter = iter;
       len = 0.0;
-      while (len + front_iter->length <= iter->cut_dist_forward) {
-        len += front_iter->length;
-        front_iter++;
-        if (front_iter == edges.end()) {
+      while (len + e[front_iter].length <= cut_dist_forward) {
+        len += e[front_iter].length;
+        front_iter = edges.next[front_iter];
+        if (front_iter == NO_EDGE) {
           if (!wrap) {
-            front_iter = std::prev(front_iter, 2);
+            front_iter = edges.prev[edges.last];
             break;
           }
-          front_iter = edges.begin();
+          front_iter = edges.first;
         }
       }
-      length_reduction = (iter->cut_dist_forward - len) / front_iter->length;
-      beyond = std::next(front_iter, 1);
-      if (wrap && beyond == edges.end()) beyond = edges.begin();
-      Point_2 new_target = front_iter->source + Vector_2(front_iter->source, beyond->source) * Kernel::FT(length_reduction);
-      front_iter->source = new_target;
-      front_iter->length *= 1.0 - length_reduction;
-      front_iter->corner = true;
-      front_iter->cut_dist_forward = iter->cut_dist_forward * 0.5;
-      double new_length = CGAL::sqrt(CGAL::to_double((new_target - new_source).squared_length().exact()));
-      auto new_edge = edges.insert(std::next(back_iter, 1), {
+      length_reduction = (cut_dist_forward - len) / e[front_iter].length;
+      beyond = edges.next[front_iter];
+      if (wrap && beyond == NO_EDGE) beyond = edges.first;
+      Point new_target = e[front_iter].source + Vector(e[front_iter].source, e[beyond].source) * typename K::FT(length_reduction);
+      e[front_iter].source = new_target;
+      e[front_iter].length *= 1.0 - length_reduction;
+      e[front_iter].corner = true;
+      e[front_iter].cut_dist_forward = cut_dist_forward * 0.5;
+      double new_length = CGAL::sqrt(exact_double((new_target - new_source).squared_length()));
+      size_t new_edge = edges.insert_after(back_iter, {
         new_source,
         new_length,
         true,
-        iter->cut_dist_back * 0.5,
+        cut_dist_back * 0.5,
         new_length * 0.25
       });
-      front_iter->cut_dist_back = new_length * 0.25;
-      auto edge_iter = std::next(new_edge, 1);
-      if (wrap && edge_iter == edges.end()) edge_iter = edges.begin();
+      e[front_iter].cut_dist_back = new_length * 0.25;
+      size_t edge_iter = edges.next[new_edge];
+      if (wrap && edge_iter == NO_EDGE) edge_iter = edges.first;
       while (edge_iter != front_iter) {
-        auto remove_edge = edge_iter;
-        edge_iter++;
-        if (edge_iter == edges.end()) {
+        size_t remove_edge = edge_iter;
+        edge_iter = edges.next[edge_iter];
+        if (edge_iter == NO_EDGE) {
           if (!wrap) break;
-          edge_iter = edges.begin();
+          edge_iter = edges.first;
         }
         edges.erase(remove_edge);
       }
       iter = next_corner;
     }
+    edges.compact_to(buffer);
+    std::swap(edges, buffer);
     n_cut--;
   }
 
-  std::vector<Point_2> new_poly;
-  std::transform(edges.begin(), edges.end(), std::back_inserter(new_poly), [](const Edge& e) { return e.source; });
+  std::vector<Point> new_poly;
+  new_poly.reserve(edges.n_edges);
+  for (size_t i = edges.first; i != NO_EDGE; i = edges.next[i]) {
+    new_poly.push_back(e[i].source);
+  }
 
   return new_poly;
 }
 
-std::list<Edge> create_edge_ring(const Segment_trait::Polygon_2& poly, double max_angle, double max_cut) {
-  std::list<Edge> ring;
-  auto segment_start = poly.edges_circulator();
-  auto s_iter = segment_start;
-  do {
-    auto last_edge = std::prev(s_iter, 1);
-    auto last_len = ring.size() == 0 ? CGAL::sqrt(CGAL::to_double(last_edge->squared_length().exact())) : ring.back().length;
-    double cur_len = CGAL::sqrt(CGAL::to_double(s_iter->squared_length().exact()));
-    Vector_2 a = Vector_2(*last_edge) * Kernel::FT(cur_len);
-    Vector_2 b = Vector_2(*s_iter) * Kernel::FT(last_len);
-    double angle = 3.14159265359 - std::atan2(CGAL::sqrt(CGAL::to_double((a - b).squared_length().exact())),
-                                              CGAL::sqrt(CGAL::to_double((a + b).squared_length().exact())));
-    ring.push_back({s_iter->source(), cur_len, angle < max_angle, 0.0, 0.0});
-  } while (++s_iter != segment_start);
+// A position along a ring or line given as the index of the edge and the
+// fraction along it. Edge indices of rings may fall outside the ring so that
+// positions around a corner can be compared across the start of the ring
+struct Path_pos {
+  long edge;
+  double t;
+};
+
+// Whether `a` comes before `b`. Positions closer than a small fraction of an
+// edge are considered equal so that spans meeting at the same point, as they do
+// halfway between two corners, do not emit it twice
+static bool before(const Path_pos& a, const Path_pos& b) {
+  const double eps = 1e-9;
+  if (a.edge == b.edge) return a.t + eps < b.t;
+  if (a.edge + 1 == b.edge) return a.t + eps < 1.0 + b.t;
+  return a.edge < b.edge;
+}
+
+static Path_pos shift_pos(Path_pos pos, long n) {
+  pos.edge += n;
+  return pos;
+}
+
+template<typename K>
+Path_pos walk_back(const std::vector< Edge<K> >& e, long corner, double dist, bool wrap) {
+  long n = e.size();
+  long j = corner - 1;
+  while (corner - j <= n) {
+    if (!wrap && j < 0) break;
+    double len = e[(j % n + n) % n].length;
+    if (dist <= len) {
+      if (len <= 0) return {j + 1, 0.0};
+      double t = 1.0 - dist / len;
+      return t >= 1.0 ? Path_pos{j + 1, 0.0} : Path_pos{j, t};
+    }
+    dist -= len;
+    j--;
+  }
+  return {j + 1, 0.0};
+}
+
+template<typename K>
+Path_pos walk_forward(const std::vector< Edge<K> >& e, long corner, double dist, bool wrap) {
+  long n = e.size();
+  long j = corner;
+  while (j - corner < n) {
+    // The last edge of a line is its end point
+    if (!wrap && j >= n - 1) return {n - 1, 0.0};
+    double len = e[j % n].length;
+    if (dist < len) return {j, dist / len};
+    dist -= len;
+    j++;
+  }
+  return {j, 0.0};
+}
+
+template<typename K>
+typename K::Point_2 point_at(const std::vector< Edge<K> >& e, Path_pos pos) {
+  long n = e.size();
+  const typename K::Point_2& source = e[(pos.edge % n + n) % n].source;
+  if (pos.t == 0.0) return source;
+  const typename K::Point_2& target = e[((pos.edge + 1) % n + n) % n].source;
+  return source + typename K::Vector_2(source, target) * typename K::FT(pos.t);
+}
 
+// Evaluate the curve that repeated corner cutting converges to directly. Each
+// corner becomes the quadratic bezier with the corner vertex as control point
+// and the points at twice the cut distances along the path as end points. The
+// curve is sampled uniformly with the number of segments chosen so that the
+// chords deviate at most `tolerance` from it. Non-corner vertices inside the
+// span of a corner are dropped, like they are by the first cut
+template<typename K>
+std::vector<typename K::Point_2> smooth_corners(const Edge_chain<K>& edges, double tolerance, bool wrap) {
+  typedef typename K::Point_2 Point;
+  typedef typename K::Vector_2 Vector;
+  const std::vector< Edge<K> >& e = edges.edges;
+  long n = e.size();
+  std::vector<long> corners;
+  for (long i = 0; i < n; ++i) {
+    if (e[i].corner) corners.push_back(i);
+  }
+  std::vector<Point> new_poly;
+  if (corners.empty()) {
+    for (long i = 0; i < n; ++i) new_poly.push_back(e[i].source);
+    return new_poly;
+  }
+
+  std::vector<Path_pos> span_start(corners.size());
+  std::vector<Path_pos> span_end(corners.size());
+  for (size_t k = 0; k < corners.size(); ++k) {
+    const Edge<K>& corner = e[corners[k]];
+    span_start[k] = walk_back(e, corners[k], 2.0 * corner.cut_dist_back, wrap);
+    span_end[k] = walk_forward(e, corners[k], 2.0 * corner.cut_dist_forward, wrap);
+  }
+
+  Path_pos last = wrap ? shift_pos(span_end.back(), -n) : Path_pos{-1, 0.0};
+  for (size_t k = 0; k < corners.size(); ++k) {
+    for (long v = last.edge; v <= span_start[k].edge; ++v) {
+      Path_pos vertex = {v, 0.0};
+      if (before(last, vertex) && before(vertex, span_start[k])) new_poly.push_back(e[(v % n + n) % n].source);
+    }
+    Point p0 = point_at(e, span_start[k]);
+    const Point& p1 = e[corners[k]].source;
+    Point p2 = point_at(e, span_end[k]);
+    if (before(last, span_start[k])) new_poly.push_back(p0);
+
+    Vector a = p0 - p1;
+    Vector b = p2 - p1;
+    double second_diff = std::sqrt(CGAL::to_double((a + b).squared_length()));
+    size_t n_seg = std::max(1.0, std::ceil(std::sqrt(second_diff / (4.0 * tolerance))));
+    for (size_t i = 1; i < n_seg; ++i) {
+      double t = double(i) / double(n_seg);
+      new_poly.push_back(p1 + a * typename K::FT((1.0 - t) * (1.0 - t)) + b * typename K::FT(t * t));
+    }
+    new_poly.push_back(p2);
+    last = span_end[k];
+  }
+  if (!wrap) {
+    for (long v = last.edge; v < n; ++v) {
+      Path_pos vertex = {v, 0.0};
+      if (before(last, vertex)) new_poly.push_back(e[v].source);
+    }
+  }
+
+  return new_poly;
+}
+
+template<typename Ring>
+Edge_chain<typename Ring::Traits> create_edge_ring(const Ring& poly, double max_angle, double max_cut) {
+  typedef typename Ring::Traits K;
+  Edge_chain<K> ring;
+  size_t n = poly.size();
+  ring.reserve(n * 2);
+  Coords coords = extract_coords(poly);
+  std::vector<double> lengths = edge_lengths(coords, true);
+  std::vector<double> angles = turning_angles(coords, lengths, true);
+  for (size_t i = 0; i < n; ++i) {
+    ring.push_back({poly.vertex(i), lengths[i], angles[i] < max_angle, 0.0, 0.0});
+  }
+
+  std::vector< Edge<K> >& e = ring.edges;
   double last_cut = 0.0;
-  auto corner = ring.end();
-  for (auto iter = ring.begin(); iter != ring.end(); iter++) {
-    if (iter->corner) {
-      if (corner == ring.end()) corner = iter;
-      iter->cut_dist_back = last_cut;
+  size_t corner = NO_EDGE;
+  for (size_t i = 0; i < n; ++i) {
+    if (e[i].corner) {
+      if (corner == NO_EDGE) corner = i;
+      e[i].cut_dist_back = last_cut;
       double dist_to_next = 0.0;
-      auto forward_iter = iter;
+      size_t j = i;
       do {
-        dist_to_next += forward_iter->length;
-        forward_iter++;
-        if (forward_iter == ring.end()) {
-          forward_iter = ring.begin();
-        }
-      } while (!forward_iter->corner);
+        dist_to_next += e[j].length;
+        j = j + 1 == n ? 0 : j + 1;
+      } while (!e[j].corner);
       last_cut = std::min(dist_to_next * 0.5, max_cut) * 0.5;
-      iter->cut_dist_forward = last_cut;
+      e[i].cut_dist_forward = last_cut;
     }
   }
 
   // No corners
-  if (corner != ring.end()) corner->cut_dist_back = last_cut;
+  if (corner != NO_EDGE) e[corner].cut_dist_back = last_cut;
 
   return ring;
 }
 
-std::list<Edge> create_edge_line(const Polyline& poly, double max_angle, double max_cut) {
-  std::list<Edge> line;
-  for (auto iter = poly.edges_begin(); iter != poly.edges_end(); iter++) {
-    double cur_len = CGAL::sqrt(CGAL::to_double(iter->squared_length().exact()));
-    if (line.size() == 0) {
-      line.push_back({iter->source(), cur_len, false, 0.0, 0.0});
-    } else {
-      auto last_edge = std::prev(iter, 1);
-      auto last_len = line.back().length;
-      Vector_2 a = Vector_2(*last_edge) * Kernel::FT(cur_len);
-      Vector_2 b = Vector_2(*iter) * Kernel::FT(last_len);
-      double angle = 3.14159265359 - std::atan2(CGAL::sqrt(CGAL::to_double((a - b).squared_length().exact())),
-                                                CGAL::sqrt(CGAL::to_double((a + b).squared_length().exact())));
-      line.push_back({iter->source(), cur_len, angle < max_angle, 0.0, 0.0});
-    }
+template<typename Point>
+Edge_chain<typename CGAL::Kernel_traits<Point>::Kernel> create_edge_line(const std::vector<Point>& points, double max_angle, double max_cut) {
+  typedef typename CGAL::Kernel_traits<Point>::Kernel K;
+  Edge_chain<K> line;
+  size_t n = points.size();
+  line.reserve(n * 2);
+  Coords coords = extract_coords(points);
+  std::vector<double> lengths = edge_lengths(coords, false);
+  std::vector<double> angles = turning_angles(coords, lengths, false);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    line.push_back({points[i], lengths[i], i != 0 && angles[i] < max_angle, 0.0, 0.0});
   }
-  line.push_back({*std::prev(poly.vertices_end(), 1), 0.0, false, 0.0, 0.0});
+  line.push_back({points.back(), 0.0, false, 0.0, 0.0});
 
+  std::vector< Edge<K> >& e = line.edges;
   double last_cut = 0.0;
-  auto corner = line.begin();
-  while (corner != line.end()) {
-    if (corner->corner) break;
-    last_cut += corner->length;
+  size_t corner = 0;
+  while (corner < n) {
+    if (e[corner].corner) break;
+    last_cut += e[corner].length;
     corner++;
   }
   last_cut = std::min(last_cut, max_cut) * 0.5;
-  if (corner == line.end()) {
+  if (corner == n) {
     return line;
   }
-  for (auto iter = corner; iter != line.end(); iter++) {
-    if (iter->corner) {
-      iter->cut_dist_back = last_cut;
+  for (size_t i = corner; i < n; ++i) {
+    if (e[i].corner) {
+      e[i].cut_dist_back = last_cut;
       double dist_to_next = 0.0;
-      auto forward_iter = iter;
+      size_t j = i;
       do {
-        dist_to_next += forward_iter->length;
-        forward_iter++;
-      } while (forward_iter != line.end() && !forward_iter->corner);
-      last_cut = std::min(dist_to_next * (forward_iter == line.end() ? 1.0 : 0.5), max_cut) * 0.5;
-      iter->cut_dist_forward = last_cut;
+        dist_to_next += e[j].length;
+        j++;
+      } while (j < n && !e[j].corner);
+      last_cut = std::min(dist_to_next * (j == n ? 1.0 : 0.5), max_cut) * 0.5;
+      e[i].cut_dist_forward = last_cut;
     }
   }
 
   return line;
 }
 
-Segment_trait::Polygon_2 clip_corner_ring(const Segment_trait::Polygon_2& poly, double max_angle, double max_cut, size_t n_cut) {
-  std::list<Edge> ring = create_edge_ring(poly, max_angle, max_cut);
+template<typename Ring>
+Ring clip_corner_ring(const Ring& poly, double max_angle, double max_cut, size_t n_cut, double tolerance) {
+  auto ring = create_edge_ring(poly, max_angle, max_cut);
 
-  std::vector<Point_2> new_poly = cut_corners(ring, n_cut, true);
+  auto new_poly = tolerance > 0 ? smooth_corners(ring, tolerance, true) : cut_corners(ring, n_cut, true);
 
   return {new_poly.begin(), new_poly.end()};
 }
 
-Polygon clip_corner_ring(const Polygon& poly, double max_angle, double max_cut, size_t n_cut) {
-  Polygon new_poly;
+template<typename PWH>
+PWH clip_corner_polygon(const PWH& poly, double max_angle, double max_cut, size_t n_cut, double tolerance) {
+  PWH new_poly;
   if (!poly.is_unbounded()) {
-    new_poly = Polygon(clip_corner_ring(poly.outer_boundary(), max_angle, max_cut, n_cut));
+    new_poly = PWH(clip_corner_ring(poly.outer_boundary(), max_angle, max_cut, n_cut, tolerance));
   }
   for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
-    new_poly.add_hole(clip_corner_ring(*iter, max_angle, max_cut, n_cut));
+    new_poly.add_hole(clip_corner_ring(*iter, max_angle, max_cut, n_cut, tolerance));
   }
 
   return new_poly;
 }
 
-Polyline clip_corner_line(const Polyline& poly, double max_angle, double max_cut, size_t n_cut) {
-  std::list<Edge> line = create_edge_line(poly, max_angle, max_cut);
-
-  std::vector<Point_2> new_poly = cut_corners(line, n_cut, false);
+template<typename Point>
+std::vector<Point> clip_corner_line(const std::vector<Point>& points, double max_angle, double max_cut, size_t n_cut, double tolerance) {
+  auto line = create_edge_line(points, max_angle, max_cut);
 
-  return {new_poly.begin(), new_poly.end()};
+  if (tolerance > 0) return smooth_corners(line, tolerance, false);
+  return cut_corners(line, n_cut, false);
 }
 
 [[cpp11::register]]
-SEXP poly_corner_cutting(SEXP poly, cpp11::doubles max_angle, cpp11::doubles max_cut, cpp11::integers n_cut) {
+SEXP poly_corner_cutting(SEXP poly, cpp11::doubles max_angle, cpp11::doubles max_cut, cpp11::integers n_cut, cpp11::doubles tolerance, bool fast) {
+  std::vector<double> angles(max_angle.begin(), max_angle.end());
+  std::vector<double> cuts(max_cut.begin(), max_cut.end());
+  std::vector<int> n_cuts(n_cut.begin(), n_cut.end());
+  std::vector<double> tolerances(tolerance.begin(), tolerance.end());
+  Profile_scope profile("poly_corner_cutting");
+  Phase_timer input(PHASE_INPUT);
   switch (polyclid::get_geometry_type(poly)) {
     case polyclid::POLYGON: {
       std::vector<Polygon> polygons = polyclid::get_polygon_vec(poly);
-      std::vector<Polygon> res;
-      res.reserve(polygons.size());
-      for (size_t i = 0; i < polygons.size(); ++i) {
+      input.stop(polygons.size());
+      std::vector<Polygon> res(polygons.size());
+      parallel_for(polygons.size(), [&](size_t i) {
         if (polygons[i].is_na()) {
-          res.push_back(Polygon::NA_value());
+          res[i] = Polygon::NA_value();
+          return;
+        }
+        double angle = angles[i % angles.size()];
+        double cut = cuts[i % cuts.size()];
+        int n = n_cuts[i % n_cuts.size()];
+        double tol = tolerances[i % tolerances.size()];
+        if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          I_Polygon ipoly = exact_to_inexact_poly(polygons[i]);
+          timer.next(PHASE_ALGORITHM);
+          ipoly = clip_corner_polygon(ipoly, angle, cut, n, tol);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_poly(ipoly);
         } else {
-          res.push_back(clip_corner_ring(polygons[i], max_angle[i % max_angle.size()], max_cut[i % max_cut.size()], n_cut[i % n_cut.size()]));
+          Phase_timer timer(PHASE_ALGORITHM);
+          res[i] = clip_corner_polygon(polygons[i], angle, cut, n, tol);
         }
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
       return polyclid::create_polygon_vec(res);
     }
     case polyclid::POLYLINE: {
       std::vector<Polyline> polylines = polyclid::get_polyline_vec(poly);
-      std::vector<Polyline> res;
-      res.reserve(polylines.size());
-      for (size_t i = 0; i < polylines.size(); ++i) {
+      input.stop(polylines.size());
+      std::vector<Polyline> res(polylines.size());
+      parallel_for(polylines.size(), [&](size_t i) {
         if (polylines[i].is_na()) {
-          res.push_back(Polyline::NA_value());
+          res[i] = Polyline::NA_value();
+          return;
+        }
+        double angle = angles[i % angles.size()];
+        double cut = cuts[i % cuts.size()];
+        int n = n_cuts[i % n_cuts.size()];
+        double tol = tolerances[i % tolerances.size()];
+        if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          std::vector<I_Kernel::Point_2> ipoints = exact_to_inexact_line(polylines[i]);
+          timer.next(PHASE_ALGORITHM);
+          ipoints = clip_corner_line(ipoints, angle, cut, n, tol);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_line(ipoints);
         } else {
-          res.push_back(clip_corner_line(polylines[i], max_angle[i % max_angle.size()], max_cut[i % max_cut.size()], n_cut[i % n_cut.size()]));
+          Phase_timer timer(PHASE_ALGORITHM);
+          std::vector<Point_2> points(polylines[i].vertices_begin(), polylines[i].vertices_end());
+          std::vector<Point_2> new_line = clip_corner_line(points, angle, cut, n, tol);
+          res[i] = Polyline(new_line.begin(), new_line.end());
         }
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
       return polyclid::create_polyline_vec(res);
     }
     default: cpp11::stop("Geometry not supported");
@@ -6,38 +6,136 @@
 #include <R_ext/Visibility.h>
 
 // add_detail.cpp
-SEXP poly_add_detail(SEXP poly, cpp11::integers c, cpp11::doubles l, cpp11::integers n, bool use_l, bool use_n);
-extern "C" SEXP _boundaries_poly_add_detail(SEXP poly, SEXP c, SEXP l, SEXP n, SEXP use_l, SEXP use_n) {
+SEXP poly_add_detail(SEXP poly, cpp11::integers c, cpp11::doubles l, cpp11::integers n, bool use_l, bool use_n, bool fast);
+extern "C" SEXP _boundaries_poly_add_detail(SEXP poly, SEXP c, SEXP l, SEXP n, SEXP use_l, SEXP use_n, SEXP fast) {
   BEGIN_CPP11
-    return cpp11::as_sexp(poly_add_detail(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(c), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(l), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n), cpp11::as_cpp<cpp11::decay_t<bool>>(use_l), cpp11::as_cpp<cpp11::decay_t<bool>>(use_n)));
+    return cpp11::as_sexp(poly_add_detail(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(c), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(l), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n), cpp11::as_cpp<cpp11::decay_t<bool>>(use_l), cpp11::as_cpp<cpp11::decay_t<bool>>(use_n), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
   END_CPP11
 }
 // corner_clip.cpp
-SEXP poly_corner_cutting(SEXP poly, cpp11::doubles max_angle, cpp11::doubles max_cut, cpp11::integers n_cut);
-extern "C" SEXP _boundaries_poly_corner_cutting(SEXP poly, SEXP max_angle, SEXP max_cut, SEXP n_cut) {
+SEXP poly_corner_cutting(SEXP poly, cpp11::doubles max_angle, cpp11::doubles max_cut, cpp11::integers n_cut, cpp11::doubles tolerance, bool fast);
+extern "C" SEXP _boundaries_poly_corner_cutting(SEXP poly, SEXP max_angle, SEXP max_cut, SEXP n_cut, SEXP tolerance, SEXP fast) {
   BEGIN_CPP11
-    return cpp11::as_sexp(poly_corner_cutting(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(max_angle), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(max_cut), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n_cut)));
+    return cpp11::as_sexp(poly_corner_cutting(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(max_angle), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(max_cut), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n_cut), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(tolerance), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
   END_CPP11
 }
 // minkowski.cpp
-SEXP polygon_minkowski_offset(SEXP polygons, SEXP offset, cpp11::integers n, double eps);
-extern "C" SEXP _boundaries_polygon_minkowski_offset(SEXP polygons, SEXP offset, SEXP n, SEXP eps) {
+SEXP polygon_minkowski_offset(SEXP polygons, SEXP offset, cpp11::integers n, cpp11::doubles arc_tolerance, double eps);
+extern "C" SEXP _boundaries_polygon_minkowski_offset(SEXP polygons, SEXP offset, SEXP n, SEXP arc_tolerance, SEXP eps) {
   BEGIN_CPP11
-    return cpp11::as_sexp(polygon_minkowski_offset(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons), cpp11::as_cpp<cpp11::decay_t<SEXP>>(offset), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n), cpp11::as_cpp<cpp11::decay_t<double>>(eps)));
+    return cpp11::as_sexp(polygon_minkowski_offset(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons), cpp11::as_cpp<cpp11::decay_t<SEXP>>(offset), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(n), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(arc_tolerance), cpp11::as_cpp<cpp11::decay_t<double>>(eps)));
   END_CPP11
 }
 // minkowski.cpp
-SEXP polygon_minkowski_sum(SEXP p, SEXP q);
-extern "C" SEXP _boundaries_polygon_minkowski_sum(SEXP p, SEXP q) {
+SEXP polygon_minkowski_sum(SEXP p, SEXP q, int method);
+extern "C" SEXP _boundaries_polygon_minkowski_sum(SEXP p, SEXP q, SEXP method) {
   BEGIN_CPP11
-    return cpp11::as_sexp(polygon_minkowski_sum(cpp11::as_cpp<cpp11::decay_t<SEXP>>(p), cpp11::as_cpp<cpp11::decay_t<SEXP>>(q)));
+    return cpp11::as_sexp(polygon_minkowski_sum(cpp11::as_cpp<cpp11::decay_t<SEXP>>(p), cpp11::as_cpp<cpp11::decay_t<SEXP>>(q), cpp11::as_cpp<cpp11::decay_t<int>>(method)));
+  END_CPP11
+}
+// offset.cpp
+cpp11::writable::list polygon_offset_stats(SEXP polygons);
+extern "C" SEXP _boundaries_polygon_offset_stats(SEXP polygons) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(polygon_offset_stats(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons)));
+  END_CPP11
+}
+// output.cpp
+int set_output_policy(int policy);
+extern "C" SEXP _boundaries_set_output_policy(SEXP policy) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(set_output_policy(cpp11::as_cpp<cpp11::decay_t<int>>(policy)));
+  END_CPP11
+}
+// parallel.cpp
+int set_thread_count(int n);
+extern "C" SEXP _boundaries_set_thread_count(SEXP n) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(set_thread_count(cpp11::as_cpp<cpp11::decay_t<int>>(n)));
+  END_CPP11
+}
+// parallel.cpp
+int hardware_thread_count();
+extern "C" SEXP _boundaries_hardware_thread_count() {
+  BEGIN_CPP11
+    return cpp11::as_sexp(hardware_thread_count());
+  END_CPP11
+}
+// profile.cpp
+bool set_profiling(int enable);
+extern "C" SEXP _boundaries_set_profiling(SEXP enable) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(set_profiling(cpp11::as_cpp<cpp11::decay_t<int>>(enable)));
+  END_CPP11
+}
+// profile.cpp
+bool set_memory_profiling(bool enable);
+extern "C" SEXP _boundaries_set_memory_profiling(SEXP enable) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(set_memory_profiling(cpp11::as_cpp<cpp11::decay_t<bool>>(enable)));
+  END_CPP11
+}
+// profile.cpp
+cpp11::writable::list get_profile_log(bool reset);
+extern "C" SEXP _boundaries_get_profile_log(SEXP reset) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(get_profile_log(cpp11::as_cpp<cpp11::decay_t<bool>>(reset)));
   END_CPP11
 }
 // simplify.cpp
-SEXP poly_simplify(SEXP poly, int cost, int stop, double cost_par, double stop_par);
-extern "C" SEXP _boundaries_poly_simplify(SEXP poly, SEXP cost, SEXP stop, SEXP cost_par, SEXP stop_par) {
+SEXP poly_simplify(SEXP poly, int cost, int stop, double cost_par, double stop_par, bool fast);
+extern "C" SEXP _boundaries_poly_simplify(SEXP poly, SEXP cost, SEXP stop, SEXP cost_par, SEXP stop_par, SEXP fast) {
   BEGIN_CPP11
-    return cpp11::as_sexp(poly_simplify(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<int>>(cost), cpp11::as_cpp<cpp11::decay_t<int>>(stop), cpp11::as_cpp<cpp11::decay_t<double>>(cost_par), cpp11::as_cpp<cpp11::decay_t<double>>(stop_par)));
+    return cpp11::as_sexp(poly_simplify(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<int>>(cost), cpp11::as_cpp<cpp11::decay_t<int>>(stop), cpp11::as_cpp<cpp11::decay_t<double>>(cost_par), cpp11::as_cpp<cpp11::decay_t<double>>(stop_par), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
+  END_CPP11
+}
+// simplify.cpp
+SEXP poly_simplify_shared(SEXP poly, int cost, int stop, double cost_par, double stop_par, bool fast);
+extern "C" SEXP _boundaries_poly_simplify_shared(SEXP poly, SEXP cost, SEXP stop, SEXP cost_par, SEXP stop_par, SEXP fast) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(poly_simplify_shared(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<int>>(cost), cpp11::as_cpp<cpp11::decay_t<int>>(stop), cpp11::as_cpp<cpp11::decay_t<double>>(cost_par), cpp11::as_cpp<cpp11::decay_t<double>>(stop_par), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
+  END_CPP11
+}
+// simplify.cpp
+cpp11::writable::list poly_simplify_rank(SEXP poly, int cost, double cost_par, bool fast);
+extern "C" SEXP _boundaries_poly_simplify_rank(SEXP poly, SEXP cost, SEXP cost_par, SEXP fast) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(poly_simplify_rank(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<int>>(cost), cpp11::as_cpp<cpp11::decay_t<double>>(cost_par), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
+  END_CPP11
+}
+// simplify.cpp
+cpp11::writable::list poly_simplify_levels(SEXP poly, int cost, int stop, double cost_par, cpp11::doubles stop_par, bool fast);
+extern "C" SEXP _boundaries_poly_simplify_levels(SEXP poly, SEXP cost, SEXP stop, SEXP cost_par, SEXP stop_par, SEXP fast) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(poly_simplify_levels(cpp11::as_cpp<cpp11::decay_t<SEXP>>(poly), cpp11::as_cpp<cpp11::decay_t<int>>(cost), cpp11::as_cpp<cpp11::decay_t<int>>(stop), cpp11::as_cpp<cpp11::decay_t<double>>(cost_par), cpp11::as_cpp<cpp11::decay_t<cpp11::doubles>>(stop_par), cpp11::as_cpp<cpp11::decay_t<bool>>(fast)));
+  END_CPP11
+}
+// skeleton.cpp
+SEXP polygon_skeleton_create(SEXP polygons);
+extern "C" SEXP _boundaries_polygon_skeleton_create(SEXP polygons) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(polygon_skeleton_create(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons)));
+  END_CPP11
+}
+// skeleton.cpp
+int skeleton_length(SEXP skeletons);
+extern "C" SEXP _boundaries_skeleton_length(SEXP skeletons) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(skeleton_length(cpp11::as_cpp<cpp11::decay_t<SEXP>>(skeletons)));
+  END_CPP11
+}
+// skeleton.cpp
+cpp11::writable::strings skeleton_format(SEXP skeletons);
+extern "C" SEXP _boundaries_skeleton_format(SEXP skeletons) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(skeleton_format(cpp11::as_cpp<cpp11::decay_t<SEXP>>(skeletons)));
+  END_CPP11
+}
+// skeleton.cpp
+SEXP skeleton_subset(SEXP skeletons, cpp11::integers index);
+extern "C" SEXP _boundaries_skeleton_subset(SEXP skeletons, SEXP index) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(skeleton_subset(cpp11::as_cpp<cpp11::decay_t<SEXP>>(skeletons), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(index)));
   END_CPP11
 }
 // skeleton.cpp
@@ -48,6 +146,13 @@ extern "C" SEXP _boundaries_polygon_skeleton_offset(SEXP polygons, SEXP offset)
   END_CPP11
 }
 // skeleton.cpp
+cpp11::writable::list polygon_skeleton_offset_flat(SEXP polygons, SEXP offset);
+extern "C" SEXP _boundaries_polygon_skeleton_offset_flat(SEXP polygons, SEXP offset) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(polygon_skeleton_offset_flat(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons), cpp11::as_cpp<cpp11::decay_t<SEXP>>(offset)));
+  END_CPP11
+}
+// skeleton.cpp
 SEXP polygon_skeleton_polylineset(SEXP polygons, bool keep_boundary, bool only_inner);
 extern "C" SEXP _boundaries_polygon_skeleton_polylineset(SEXP polygons, SEXP keep_boundary, SEXP only_inner) {
   BEGIN_CPP11
@@ -55,6 +160,13 @@ extern "C" SEXP _boundaries_polygon_skeleton_polylineset(SEXP polygons, SEXP kee
   END_CPP11
 }
 // skeleton.cpp
+cpp11::writable::list polygon_skeleton_graph(SEXP polygons);
+extern "C" SEXP _boundaries_polygon_skeleton_graph(SEXP polygons) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(polygon_skeleton_graph(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons)));
+  END_CPP11
+}
+// skeleton.cpp
 SEXP polygon_skeleton_limit(SEXP polygons);
 extern "C" SEXP _boundaries_polygon_skeleton_limit(SEXP polygons) {
   BEGIN_CPP11
@@ -62,6 +174,13 @@ extern "C" SEXP _boundaries_polygon_skeleton_limit(SEXP polygons) {
   END_CPP11
 }
 // skeleton.cpp
+cpp11::writable::doubles polygon_inscribed_radius(SEXP polygons, double tolerance);
+extern "C" SEXP _boundaries_polygon_inscribed_radius(SEXP polygons, SEXP tolerance) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(polygon_inscribed_radius(cpp11::as_cpp<cpp11::decay_t<SEXP>>(polygons), cpp11::as_cpp<cpp11::decay_t<double>>(tolerance)));
+  END_CPP11
+}
+// skeleton.cpp
 SEXP polygon_skeleton_limit_location(SEXP polygons);
 extern "C" SEXP _boundaries_polygon_skeleton_limit_location(SEXP polygons) {
   BEGIN_CPP11
@@ -71,15 +190,32 @@ extern "C" SEXP _boundaries_polygon_skeleton_limit_location(SEXP polygons) {
 
 extern "C" {
 static const R_CallMethodDef CallEntries[] = {
-    {"_boundaries_poly_add_detail",                 (DL_FUNC) &_boundaries_poly_add_detail,                 6},
-    {"_boundaries_poly_corner_cutting",             (DL_FUNC) &_boundaries_poly_corner_cutting,             4},
-    {"_boundaries_poly_simplify",                   (DL_FUNC) &_boundaries_poly_simplify,                   5},
-    {"_boundaries_polygon_minkowski_offset",        (DL_FUNC) &_boundaries_polygon_minkowski_offset,        4},
-    {"_boundaries_polygon_minkowski_sum",           (DL_FUNC) &_boundaries_polygon_minkowski_sum,           2},
+    {"_boundaries_get_profile_log",                 (DL_FUNC) &_boundaries_get_profile_log,                 1},
+    {"_boundaries_hardware_thread_count",           (DL_FUNC) &_boundaries_hardware_thread_count,           0},
+    {"_boundaries_poly_add_detail",                 (DL_FUNC) &_boundaries_poly_add_detail,                 7},
+    {"_boundaries_poly_corner_cutting",             (DL_FUNC) &_boundaries_poly_corner_cutting,             6},
+    {"_boundaries_poly_simplify",                   (DL_FUNC) &_boundaries_poly_simplify,                   6},
+    {"_boundaries_poly_simplify_levels",            (DL_FUNC) &_boundaries_poly_simplify_levels,            6},
+    {"_boundaries_poly_simplify_rank",              (DL_FUNC) &_boundaries_poly_simplify_rank,              4},
+    {"_boundaries_poly_simplify_shared",            (DL_FUNC) &_boundaries_poly_simplify_shared,            6},
+    {"_boundaries_polygon_inscribed_radius",        (DL_FUNC) &_boundaries_polygon_inscribed_radius,        2},
+    {"_boundaries_polygon_minkowski_offset",        (DL_FUNC) &_boundaries_polygon_minkowski_offset,        5},
+    {"_boundaries_polygon_minkowski_sum",           (DL_FUNC) &_boundaries_polygon_minkowski_sum,           3},
+    {"_boundaries_polygon_offset_stats",            (DL_FUNC) &_boundaries_polygon_offset_stats,            1},
+    {"_boundaries_polygon_skeleton_create",         (DL_FUNC) &_boundaries_polygon_skeleton_create,         1},
+    {"_boundaries_polygon_skeleton_graph",          (DL_FUNC) &_boundaries_polygon_skeleton_graph,          1},
     {"_boundaries_polygon_skeleton_limit",          (DL_FUNC) &_boundaries_polygon_skeleton_limit,          1},
     {"_boundaries_polygon_skeleton_limit_location", (DL_FUNC) &_boundaries_polygon_skeleton_limit_location, 1},
     {"_boundaries_polygon_skeleton_offset",         (DL_FUNC) &_boundaries_polygon_skeleton_offset,         2},
+    {"_boundaries_polygon_skeleton_offset_flat",    (DL_FUNC) &_boundaries_polygon_skeleton_offset_flat,    2},
     {"_boundaries_polygon_skeleton_polylineset",    (DL_FUNC) &_boundaries_polygon_skeleton_polylineset,    3},
+    {"_boundaries_set_memory_profiling",            (DL_FUNC) &_boundaries_set_memory_profiling,            1},
+    {"_boundaries_set_output_policy",               (DL_FUNC) &_boundaries_set_output_policy,               1},
+    {"_boundaries_set_profiling",                   (DL_FUNC) &_boundaries_set_profiling,                   1},
+    {"_boundaries_set_thread_count",                (DL_FUNC) &_boundaries_set_thread_count,                1},
+    {"_boundaries_skeleton_format",                 (DL_FUNC) &_boundaries_skeleton_format,                 1},
+    {"_boundaries_skeleton_length",                 (DL_FUNC) &_boundaries_skeleton_length,                 1},
+    {"_boundaries_skeleton_subset",                 (DL_FUNC) &_boundaries_skeleton_subset,                 2},
     {NULL, NULL, 0}
 };
 }
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Cartesian_converter.h>
+
+#include <euclid.h>
+#include <polyclid.h>
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel I_Kernel;
+typedef CGAL::Cartesian_converter<I_Kernel,Kernel> I_to_E;
+typedef CGAL::Cartesian_converter<Kernel,I_Kernel> E_to_I;
+typedef CGAL::Polygon_with_holes_2<I_Kernel> I_Polygon;
+
+// Convert a number to double, forcing exact evaluation of lazy numbers first
+template<typename NT>
+inline double exact_double(const NT& x) {
+  return CGAL::to_double(x);
+}
+template<typename ET>
+inline double exact_double(const CGAL::Lazy_exact_nt<ET>& x) {
+  return CGAL::to_double(x.exact());
+}
+
+inline I_Polygon exact_to_inexact_poly(const Polygon& poly) {
+  static E_to_I converter;
+  I_Polygon ipoly;
+  std::vector<I_Kernel::Point_2> ring;
+  if (!poly.is_unbounded()) {
+    std::transform(poly.outer_boundary().vertices_begin(), poly.outer_boundary().vertices_end(),
+                   std::back_inserter(ring),
+                   [](const Point_2& p) { return converter(p); });
+    ipoly = I_Polygon(CGAL::Polygon_2<I_Kernel>(ring.begin(), ring.end()));
+  }
+  for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
+    ring.clear();
+    std::transform(iter->vertices_begin(), iter->vertices_end(),
+                   std::back_inserter(ring),
+                   [](const Point_2& p) { return converter(p); });
+    ipoly.add_hole(CGAL::Polygon_2<I_Kernel>(ring.begin(), ring.end()));
+  }
+  return ipoly;
+}
+inline Polygon inexact_to_exact_poly(const I_Polygon& ipoly) {
+  static I_to_E converter;
+  Polygon poly;
+  std::vector<Point_2> ring;
+  if (!ipoly.is_unbounded()) {
+    std::transform(ipoly.outer_boundary().vertices_begin(), ipoly.outer_boundary().vertices_end(),
+                   std::back_inserter(ring),
+                   [](const I_Kernel::Point_2& p) { return converter(p); });
+    poly = Polygon(Segment_trait::Polygon_2(ring.begin(), ring.end()));
+  }
+  for (auto iter = ipoly.holes_begin(); iter != ipoly.holes_end(); iter++) {
+    ring.clear();
+    std::transform(iter->vertices_begin(), iter->vertices_end(),
+                   std::back_inserter(ring),
+                   [](const I_Kernel::Point_2& p) { return converter(p); });
+    poly.add_hole(Segment_trait::Polygon_2(ring.begin(), ring.end()));
+  }
+  return poly;
+}
+inline std::vector<I_Kernel::Point_2> exact_to_inexact_line(const Polyline& line) {
+  static E_to_I converter;
+  std::vector<I_Kernel::Point_2> points;
+  std::transform(line.vertices_begin(), line.vertices_end(),
+                 std::back_inserter(points),
+                 [](const Point_2& p) { return converter(p); });
+  return points;
+}
+inline Polyline inexact_to_exact_line(const std::vector<I_Kernel::Point_2>& points) {
+  static I_to_E converter;
+  std::vector<Point_2> line;
+  std::transform(points.begin(), points.end(),
+                 std::back_inserter(line),
+                 [](const I_Kernel::Point_2& p) { return converter(p); });
+  return {line.begin(), line.end()};
+}
+inline std::vector<I_Kernel::Segment_2> inexact_edges(const std::vector<I_Kernel::Point_2>& points) {
+  std::vector<I_Kernel::Segment_2> edges;
+  for (size_t i = 1; i < points.size(); ++i) {
+    edges.emplace_back(points[i - 1], points[i]);
+  }
+  return edges;
+}
@@ -0,0 +1,174 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <gmp.h>
+
+#if defined(BOUNDARIES_TRACK_HEAP) && defined(__GLIBC__)
+#include <malloc.h>
+#define TRACK_HEAP
+#endif
+
+#include "memory.h"
+
+struct Alloc_counters {
+  std::atomic<long long> count[N_PROFILE_PHASES + 1];
+  std::atomic<long long> bytes[N_PROFILE_PHASES + 1];
+  std::atomic<long long> current;
+  std::atomic<long long> peak;
+  std::atomic<long long> base;
+};
+
+static Alloc_counters counters[N_ALLOC_SOURCES];
+
+// Only the bytes of new allocations and of reallocations that grow are counted
+// towards `bytes`. Reallocations are not counted as allocations. Frees only
+// lower the current usage
+static inline void track_alloc(Alloc_source source, long long size, bool new_alloc) {
+  Alloc_counters& c = counters[source];
+  int phase = current_phase();
+  if (new_alloc) c.count[phase]++;
+  if (size > 0) c.bytes[phase] += size;
+  long long now = c.current += size;
+  long long peak = c.peak;
+  while (now > peak && !c.peak.compare_exchange_weak(peak, now)) {}
+}
+
+static inline void track_free(Alloc_source source, long long size) {
+  counters[source].current -= size;
+}
+
+// The hooks pass everything on to the functions that were in place before
+// they were installed, so memory allocated before or after tracking is turned
+// on can always be freed by either. If others have installed their own
+// functions on top of ours by the time tracking is turned off, ours are left
+// in place underneath theirs and only count while tracking is on
+static void* (*gmp_alloc_prev)(size_t) = nullptr;
+static void* (*gmp_realloc_prev)(void*, size_t, size_t) = nullptr;
+static void (*gmp_free_prev)(void*, size_t) = nullptr;
+static bool gmp_hooks_installed = false;
+static std::atomic<bool> gmp_tracking(false);
+
+static void* gmp_alloc(size_t size) {
+  if (gmp_tracking.load(std::memory_order_relaxed)) {
+    track_alloc(ALLOC_GMP, size, true);
+  }
+  return gmp_alloc_prev(size);
+}
+
+static void* gmp_realloc(void* ptr, size_t old_size, size_t new_size) {
+  if (gmp_tracking.load(std::memory_order_relaxed)) {
+    track_alloc(ALLOC_GMP, (long long) new_size - (long long) old_size, false);
+  }
+  return gmp_realloc_prev(ptr, old_size, new_size);
+}
+
+static void gmp_free(void* ptr, size_t size) {
+  if (gmp_tracking.load(std::memory_order_relaxed)) {
+    track_free(ALLOC_GMP, size);
+  }
+  gmp_free_prev(ptr, size);
+}
+
+static bool gmp_hooks_active() {
+  void* (*alloc_fun)(size_t);
+  void* (*realloc_fun)(void*, size_t, size_t);
+  void (*free_fun)(void*, size_t);
+  mp_get_memory_functions(&alloc_fun, &realloc_fun, &free_fun);
+  return alloc_fun == gmp_alloc && realloc_fun == gmp_realloc && free_fun == gmp_free;
+}
+
+bool set_gmp_tracking(bool enable) {
+  bool old = gmp_tracking;
+  if (enable == old) {
+    return old;
+  }
+  if (enable && !gmp_hooks_installed) {
+    mp_get_memory_functions(&gmp_alloc_prev, &gmp_realloc_prev, &gmp_free_prev);
+    mp_set_memory_functions(gmp_alloc, gmp_realloc, gmp_free);
+    gmp_hooks_installed = true;
+  } else if (!enable && gmp_hooks_active()) {
+    mp_set_memory_functions(gmp_alloc_prev, gmp_realloc_prev, gmp_free_prev);
+    gmp_hooks_installed = false;
+  }
+  gmp_tracking = enable;
+  return old;
+}
+
+static std::atomic<bool> heap_tracking(false);
+
+bool set_heap_tracking(bool enable) {
+#ifdef TRACK_HEAP
+  return heap_tracking.exchange(enable);
+#else
+  return false;
+#endif
+}
+
+bool alloc_tracked(Alloc_source source) {
+  switch (source) {
+  case ALLOC_GMP: return gmp_tracking;
+  case ALLOC_HEAP: return heap_tracking;
+  default: return false;
+  }
+}
+
+void reset_alloc_stats() {
+  for (int i = 0; i < N_ALLOC_SOURCES; ++i) {
+    Alloc_counters& c = counters[i];
+    for (int j = 0; j <= N_PROFILE_PHASES; ++j) {
+      c.count[j] = 0;
+      c.bytes[j] = 0;
+    }
+    c.base = c.current.load();
+    c.peak = c.base.load();
+  }
+}
+
+Alloc_stats get_alloc_stats(Alloc_source source) {
+  Alloc_counters& c = counters[source];
+  Alloc_stats stats;
+  stats.tracked = alloc_tracked(source);
+  for (int j = 0; j <= N_PROFILE_PHASES; ++j) {
+    stats.count[j] = c.count[j];
+    stats.bytes[j] = c.bytes[j];
+  }
+  stats.peak = c.peak - c.base;
+  return stats;
+}
+
+#ifdef TRACK_HEAP
+// operator new and delete are only replaced when the package is compiled with
+// -DBOUNDARIES_TRACK_HEAP on glibc, and even then only do more than calling
+// malloc() and free() while heap tracking is turned on. The
+// usable size is used on both allocation and deallocation so memory allocated
+// while tracking was off, or by the default operator new elsewhere, can be
+// freed here and the other way around. Both end up in malloc
+void* operator new(size_t size) {
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  if (heap_tracking.load(std::memory_order_relaxed)) {
+    track_alloc(ALLOC_HEAP, malloc_usable_size(ptr), true);
+  }
+  return ptr;
+}
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+void operator delete(void* ptr) noexcept {
+  if (ptr == nullptr) return;
+  if (heap_tracking.load(std::memory_order_relaxed)) {
+    track_free(ALLOC_HEAP, malloc_usable_size(ptr));
+  }
+  std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+  operator delete(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+#endif
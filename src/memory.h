@@ -0,0 +1,40 @@
+#pragma once
+
+#include "profile.h"
+
+// The allocators that can be tracked when profiling memory. GMP allocations
+// cover the exact numbers of CGAL as well as MPFR, which allocates through the
+// GMP memory functions. Heap allocations are the ones made with operator new
+// and are only tracked if the package is compiled with -DBOUNDARIES_TRACK_HEAP
+// on a platform using glibc
+enum Alloc_source {
+  ALLOC_GMP = 0,
+  ALLOC_HEAP = 1,
+  N_ALLOC_SOURCES = 2
+};
+
+// Allocations made outside of any timed phase are attributed to this slot
+const int PHASE_NONE = N_PROFILE_PHASES;
+
+struct Alloc_stats {
+  bool tracked;
+  double count[N_PROFILE_PHASES + 1];
+  double bytes[N_PROFILE_PHASES + 1];
+  // The highest number of bytes in use above the level at the last reset
+  double peak;
+};
+
+// Installs the GMP memory function hooks or removes them if no others have
+// been installed on top of them since. Returns the old setting
+bool set_gmp_tracking(bool enable);
+
+// Turns counting in operator new on or off. Does nothing unless compiled with
+// heap tracking. Returns the old setting
+bool set_heap_tracking(bool enable);
+
+bool alloc_tracked(Alloc_source source);
+
+// Zeroes the counts and sets the level peak usage is measured from
+void reset_alloc_stats();
+
+Alloc_stats get_alloc_stats(Alloc_source source);
@@ -1,6 +1,7 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <cmath>
 
 #include <cpp11/declarations.hpp>
 #include <cpp11/integers.hpp>
@@ -8,19 +9,70 @@
 #include <CGAL/approximated_offset_2.h>
 #include <CGAL/Gps_circle_segment_traits_2.h>
 #include <CGAL/minkowski_sum_2.h>
+#include <CGAL/Small_side_angle_bisector_decomposition_2.h>
+#include <CGAL/Polygon_convex_decomposition_2.h>
+#include <CGAL/Polygon_vertical_decomposition_2.h>
+#include <CGAL/Polygon_triangulation_decomposition_2.h>
 
 #include <euclid.h>
 #include <polyclid.h>
 
+#include "output.h"
+#include "parallel.h"
+#include "profile.h"
+
 typedef CGAL::Gps_circle_segment_traits_2<Kernel> Traits;
 typedef Traits::Polygon_2 Circ_polygon_2;
 typedef Traits::Polygon_with_holes_2 Circ_polygon_with_holes_2;
 
-Polyline circ_to_linear_polygon(Circ_polygon_2& poly, int n) {
+// How circular arcs are converted to line segments. With a positive tolerance
+// each arc gets as many segments as its radius requires for the chords to stay
+// within the tolerance of the arc. Otherwise `n` gives the number of segments
+// for a full circle and the arcs are split by CGAL's approximate()
+struct Arc_approximation {
+  int n;
+  double tolerance;
+};
+
+// Adds the points of an arc after its source to `ring`, spaced at equal angles
+// along the supporting circle so that no chord deviates more than the tolerance
+// from the arc. approximate() spaces its points evenly in x, which makes the
+// chords near a vertical tangent span much larger angles than the others, so it
+// cannot be used to bound the deviation
+void approximate_arc(const Traits::X_monotone_curve_2& curve, const Arc_approximation& arc, std::vector<Point_2>& ring) {
+  const double two_pi = 6.283185307179586;
+  double cx = CGAL::to_double(curve.supporting_circle().center().x());
+  double cy = CGAL::to_double(curve.supporting_circle().center().y());
+  double radius = std::sqrt(CGAL::to_double(curve.supporting_circle().squared_radius()));
+  double sx = CGAL::to_double(curve.source().x()), sy = CGAL::to_double(curve.source().y());
+  double tx = CGAL::to_double(curve.target().x()), ty = CGAL::to_double(curve.target().y());
+  double start = std::atan2(sy - cy, sx - cx);
+  double sweep = std::atan2(ty - cy, tx - cx) - start;
+  if (curve.orientation() == CGAL::COUNTERCLOCKWISE) {
+    if (sweep <= 0) sweep += two_pi;
+  } else {
+    if (sweep >= 0) sweep -= two_pi;
+  }
+  // A chord spanning the angle a deviates r * (1 - cos(a / 2)) from the arc
+  double max_angle = 2.0 * std::acos(std::max(-1.0, 1.0 - arc.tolerance / radius));
+  double n_seg = std::max(std::ceil(std::abs(sweep) / max_angle), 1.0);
+  if (ring.empty()) ring.emplace_back(sx, sy);
+  for (double i = 1; i < n_seg; ++i) {
+    double angle = start + sweep * (i / n_seg);
+    ring.emplace_back(cx + radius * std::cos(angle), cy + radius * std::sin(angle));
+  }
+  ring.emplace_back(tx, ty);
+}
+
+Polyline circ_to_linear_ring(Circ_polygon_2& poly, const Arc_approximation& arc) {
   std::vector<Point_2> ring;
   std::vector< std::pair<double, double> > approx_segment;
 
   for (auto iter = poly.curves_begin(); iter != poly.curves_end(); iter++) {
+    if (iter->is_circular() && arc.tolerance > 0) {
+      approximate_arc(*iter, arc, ring);
+      continue;
+    }
     approx_segment.clear();
     int n_real = 2;
     if (iter->is_circular()) {
@@ -28,7 +80,7 @@ Polyline circ_to_linear_polygon(Circ_polygon_2& poly, int n) {
       Vector_2 vec2(iter->supporting_circle().center(), Point_2(CGAL::to_double(iter->target().x()), CGAL::to_double(iter->target().y())));
       double y = CGAL::sqrt(CGAL::to_double((vec1 - vec2).squared_length().exact()));
       double x = CGAL::sqrt(CGAL::to_double((vec1 + vec2).squared_length().exact()));
-      n_real = 1.0 + n - n * (std::atan2(y, x) / 6.283185307179586);
+      n_real = 1.0 + arc.n - arc.n * (std::atan2(y, x) / 6.283185307179586);
     }
     iter->approximate(std::back_inserter(approx_segment), n_real);
     if (approx_segment.size() == 0) continue;
@@ -42,78 +94,299 @@ Polyline circ_to_linear_polygon(Circ_polygon_2& poly, int n) {
   return {ring.begin(), ring.end()};
 }
 
-Polygon_set circ_to_linear_polygon(Circ_polygon_with_holes_2& poly, int n) {
+Polygon circ_to_linear_pwh(Circ_polygon_with_holes_2& poly, const Arc_approximation& arc) {
   Polygon res;
 
   if (!poly.is_unbounded()) {
-    res = Polygon(circ_to_linear_polygon(poly.outer_boundary(), n));
+    res = Polygon(circ_to_linear_ring(poly.outer_boundary(), arc));
   }
 
   for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
-    res.add_hole(circ_to_linear_polygon(*iter, n));
+    res.add_hole(circ_to_linear_ring(*iter, arc));
   }
 
-  return Polygon_set(res);
+  return res;
+}
+
+Polygon_set circ_to_linear_polygon(Circ_polygon_with_holes_2& poly, const Arc_approximation& arc) {
+  return Polygon_set(circ_to_linear_pwh(poly, arc));
+}
+
+Polygon_set minkowski_offset_impl(const Polygon& p, const Exact_number& r, bool inset, double eps, const Arc_approximation& arc) {
+  Phase_timer timer(PHASE_ALGORITHM);
+  if (!inset) {
+    Circ_polygon_with_holes_2 offset = CGAL::approximated_offset_2(p, r, eps);
+    timer.next(PHASE_CONVERT_BACK);
+    return circ_to_linear_polygon(offset, arc);
+  }
+  Polygon_set res;
+  std::vector<Circ_polygon_2> offset;
+  if (!p.is_unbounded()) {
+    CGAL::approximated_inset_2(p.outer_boundary(), r, eps, std::back_inserter(offset));
+    timer.next(PHASE_CONVERT_BACK);
+    for (auto iter = offset.begin(); iter != offset.end(); iter++) {
+      res.insert(circ_to_linear_ring(*iter, arc));
+    }
+  }
+  // Subtracting the holes one at a time overlays the growing result once per
+  // hole. Joining all hole offsets in one aggregated operation and subtracting
+  // the union once keeps polygons with many holes from becoming quadratic
+  std::vector<Polygon_set::Polygon_with_holes_2> hole_offsets;
+  hole_offsets.reserve(p.number_of_holes());
+  for (auto iter = p.holes_begin(); iter != p.holes_end(); iter++) {
+    Segment_trait::Polygon_2 hole(*iter);
+    hole.reverse_orientation();
+    timer.next(PHASE_ALGORITHM, 0);
+    Circ_polygon_with_holes_2 hole_offset = CGAL::approximated_offset_2(hole, r, eps);
+    timer.next(PHASE_CONVERT_BACK, 0);
+    hole_offsets.push_back(circ_to_linear_pwh(hole_offset, arc));
+  }
+  if (!hole_offsets.empty()) {
+    timer.next(PHASE_ALGORITHM, 0);
+    Polygon_set holes;
+    holes.join(hole_offsets.begin(), hole_offsets.end());
+    res.difference(holes);
+  }
+  return res;
 }
 
 [[cpp11::register]]
-SEXP polygon_minkowski_offset(SEXP polygons, SEXP offset, cpp11::integers n, double eps) {
+SEXP polygon_minkowski_offset(SEXP polygons, SEXP offset, cpp11::integers n, cpp11::doubles arc_tolerance, double eps) {
+  Profile_scope profile("polygon_minkowski_offset");
+  Phase_timer input(PHASE_INPUT);
   std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
   std::vector<Exact_number> os = euclid::get_exact_numeric_vec(offset);
+  input.stop(poly.size());
+  std::vector<int> arc_n(n.begin(), n.end());
+  std::vector<double> arc_tol(arc_tolerance.begin(), arc_tolerance.end());
 
-  size_t max_size = std::max(poly.size(), os.size());
-  std::vector<Polygon_set> res;
-  res.reserve(max_size);
-
-  for (size_t i = 0; i < max_size; ++i) {
-    Polygon p = poly[i % poly.size()];
-    Exact_number of = os[i % os.size()];
-    if (!(p.get_flag(VALIDITY_CHECKED) && p.get_flag(IS_VALID))) {
+  for (size_t i = 0; i < poly.size(); ++i) {
+    if (!(poly[i].get_flag(VALIDITY_CHECKED) && poly[i].get_flag(IS_VALID))) {
       cpp11::stop("Input polygons must be valid");
     }
+  }
+
+  size_t max_size = std::max(poly.size(), os.size());
+  std::vector<Polygon_set> res(max_size);
+
+  parallel_for(max_size, [&](size_t i) {
+    const Polygon& p = poly[i % poly.size()];
+    const Exact_number& of = os[i % os.size()];
     if (p.is_na() || of.is_na()) {
-      res.push_back(Polygon_set::NA_value());
-      continue;
+      res[i] = Polygon_set::NA_value();
+      return;
     }
+    Arc_approximation arc = {arc_n[i % arc_n.size()], arc_tol[i % arc_tol.size()]};
     if (of > 0) {
-      Circ_polygon_with_holes_2 offset = CGAL::approximated_offset_2(p, of, eps);
-      res.push_back(circ_to_linear_polygon(offset, n[i % n.size()]));
+      res[i] = minkowski_offset_impl(p, of, false, eps, arc);
     } else {
-      std::vector<Circ_polygon_2> offset;
-      res.push_back(Polygon_set());
-      if (!p.is_unbounded()) {
-        CGAL::approximated_inset_2(p.outer_boundary(), -of, eps, std::back_inserter(offset));
-        for (auto iter = offset.begin(); iter != offset.end(); iter++) {
-          res.back().insert(circ_to_linear_polygon(*iter, n[i % n.size()]));
-        }
-      }
-      for (auto iter = p.holes_begin(); iter != p.holes_end(); iter++) {
-        Segment_trait::Polygon_2 hole(*iter);
-        hole.reverse_orientation();
-        Circ_polygon_with_holes_2 hole_offset = CGAL::approximated_offset_2(hole, -of, eps);
-        res.back().difference(circ_to_linear_polygon(hole_offset, n[i % n.size()]));
-      }
+      res[i] = minkowski_offset_impl(p, -of, true, eps, arc);
     }
-  }
+  });
 
+  finalize_output(res);
+  Phase_timer output(PHASE_OUTPUT, res.size());
   return polyclid::create_polygon_set_vec(res);
 }
 
+enum Minkowski_method {
+  MINKOWSKI_REDUCED_CONVOLUTION = 0,
+  MINKOWSKI_ANGLE_BISECTOR = 1,
+  MINKOWSKI_OPTIMAL_CONVEX = 2,
+  MINKOWSKI_HERTEL_MEHLHORN = 3,
+  MINKOWSKI_GREENE = 4,
+  MINKOWSKI_VERTICAL = 5,
+  MINKOWSKI_TRIANGULATION = 6
+};
+
+typedef Polygon_set::Polygon_2 Convex_piece;
+typedef std::vector<Convex_piece> Convex_pieces;
+typedef CGAL::Polygon_2<Kernel> Simple_polygon;
+
+bool is_convex_polygon(const Polygon& poly) {
+  return !poly.is_unbounded() && poly.number_of_holes() == 0 && poly.outer_boundary().is_convex();
+}
+
+template<typename Ring>
+Convex_piece as_convex_piece(const Ring& ring) {
+  return {ring.vertices_begin(), ring.vertices_end()};
+}
+
+template<typename Strategy>
+void decompose_simple(const Polygon& poly, Convex_pieces& pieces) {
+  Simple_polygon outer(poly.outer_boundary().vertices_begin(), poly.outer_boundary().vertices_end());
+  std::vector<Simple_polygon> res;
+  Strategy decomposition;
+  decomposition(outer, std::back_inserter(res));
+  for (auto iter = res.begin(); iter != res.end(); iter++) {
+    pieces.push_back(as_convex_piece(*iter));
+  }
+}
+
+template<typename Strategy>
+void decompose_with_holes(const Polygon& poly, Convex_pieces& pieces) {
+  CGAL::Polygon_with_holes_2<Kernel> pwh(Simple_polygon(poly.outer_boundary().vertices_begin(), poly.outer_boundary().vertices_end()));
+  for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
+    pwh.add_hole(Simple_polygon(iter->vertices_begin(), iter->vertices_end()));
+  }
+  std::vector<Simple_polygon> res;
+  Strategy decomposition;
+  decomposition(pwh, std::back_inserter(res));
+  for (auto iter = res.begin(); iter != res.end(); iter++) {
+    pieces.push_back(as_convex_piece(*iter));
+  }
+}
+
+// Only the vertical and triangulation decompositions support holes. Polygons
+// with holes use the vertical decomposition for the other strategies
+Convex_pieces convex_decomposition(const Polygon& poly, Minkowski_method method) {
+  Convex_pieces pieces;
+  if (poly.is_na() || poly.is_unbounded()) {
+    return pieces;
+  }
+  if (is_convex_polygon(poly)) {
+    pieces.push_back(as_convex_piece(poly.outer_boundary()));
+    return pieces;
+  }
+  if (poly.number_of_holes() == 0) {
+    switch (method) {
+    case MINKOWSKI_ANGLE_BISECTOR:
+      decompose_simple< CGAL::Small_side_angle_bisector_decomposition_2<Kernel> >(poly, pieces);
+      return pieces;
+    case MINKOWSKI_OPTIMAL_CONVEX:
+      decompose_simple< CGAL::Optimal_convex_decomposition_2<Kernel> >(poly, pieces);
+      return pieces;
+    case MINKOWSKI_HERTEL_MEHLHORN:
+      decompose_simple< CGAL::Hertel_Mehlhorn_convex_decomposition_2<Kernel> >(poly, pieces);
+      return pieces;
+    case MINKOWSKI_GREENE:
+      decompose_simple< CGAL::Greene_convex_decomposition_2<Kernel> >(poly, pieces);
+      return pieces;
+    default: break;
+    }
+  }
+  if (method == MINKOWSKI_TRIANGULATION) {
+    decompose_with_holes< CGAL::Polygon_triangulation_decomposition_2<Kernel> >(poly, pieces);
+  } else {
+    decompose_with_holes< CGAL::Polygon_vertical_decomposition_2<Kernel> >(poly, pieces);
+  }
+  return pieces;
+}
+
+template<typename Ring>
+size_t lowest_vertex(const Ring& poly) {
+  size_t lowest = 0;
+  for (size_t i = 1; i < poly.size(); ++i) {
+    if (CGAL::compare_yx(poly.vertex(i), poly.vertex(lowest)) == CGAL::SMALLER) lowest = i;
+  }
+  return lowest;
+}
+
+// The sum of two convex counterclockwise polygons in linear time. Starting from
+// the lowest vertex of both, the edges are merged in order of direction. Works
+// directly on the boundaries of the input so they are not copied into pieces
+template<typename RingA, typename RingB>
+Convex_piece convex_minkowski_sum(const RingA& a, const RingB& b) {
+  size_t n = a.size(), m = b.size();
+  size_t start_a = lowest_vertex(a), start_b = lowest_vertex(b);
+  std::vector<Point_2> points;
+  points.reserve(n + m);
+  size_t i = 0, j = 0;
+  while (i < n || j < m) {
+    const Point_2& pa = a.vertex((start_a + i) % n);
+    const Point_2& pb = b.vertex((start_b + j) % m);
+    points.push_back(pa + (pb - CGAL::ORIGIN));
+    if (i == n) {
+      j++;
+      continue;
+    }
+    if (j == m) {
+      i++;
+      continue;
+    }
+    Vector_2 edge_a = a.vertex((start_a + i + 1) % n) - pa;
+    Vector_2 edge_b = b.vertex((start_b + j + 1) % m) - pb;
+    CGAL::Orientation turn = CGAL::orientation(edge_a, edge_b);
+    if (turn != CGAL::RIGHT_TURN) i++;
+    if (turn != CGAL::LEFT_TURN) j++;
+  }
+  return {points.begin(), points.end()};
+}
+
+// The sum of two decomposed polygons is the union of the pairwise sums of
+// their convex pieces
+Polygon minkowski_sum_decomposed(const Convex_pieces& p, const Convex_pieces& q) {
+  std::vector<Convex_piece> sums;
+  sums.reserve(p.size() * q.size());
+  for (auto p_iter = p.begin(); p_iter != p.end(); p_iter++) {
+    for (auto q_iter = q.begin(); q_iter != q.end(); q_iter++) {
+      sums.push_back(convex_minkowski_sum(*p_iter, *q_iter));
+    }
+  }
+  if (sums.size() == 1) {
+    return Polygon(sums[0]);
+  }
+  Polygon_set set;
+  set.join(sums.begin(), sums.end());
+  std::vector<Polygon_set::Polygon_with_holes_2> res;
+  set.polygons_with_holes(std::back_inserter(res));
+  // The sum of two connected polygons is connected
+  if (res.empty()) {
+    return Polygon();
+  }
+  return res[0];
+}
+
 [[cpp11::register]]
-SEXP polygon_minkowski_sum(SEXP p, SEXP q) {
+SEXP polygon_minkowski_sum(SEXP p, SEXP q, int method) {
+  Profile_scope profile("polygon_minkowski_sum");
+  Phase_timer input(PHASE_INPUT);
   std::vector<Polygon> P = polyclid::get_polygon_vec(p);
   std::vector<Polygon> Q = polyclid::get_polygon_vec(q);
+  input.stop(P.size() + Q.size());
+  Minkowski_method strategy = static_cast<Minkowski_method>(method);
   size_t max_size = std::max(P.size(), Q.size());
-  std::vector<Polygon> res;
-  res.reserve(max_size);
+  std::vector<Polygon> res(max_size);
 
-  for (size_t i = 0; i < max_size; ++i) {
-    if (P[i % P.size()].is_na() || Q[i % Q.size()].is_na()) {
-      res.push_back(Polygon::NA_value());
-      continue;
-    }
-    res.push_back(CGAL::minkowski_sum_2(P[i % P.size()], Q[i % Q.size()]));
+  // Convexity and decompositions are found once per input index, not once per
+  // sum, so a polygon recycled against many others is only analysed once.
+  // Equal polygons at different indices are not detected and are analysed
+  // once each
+  std::vector<bool> P_convex(P.size()), Q_convex(Q.size());
+  std::vector<Convex_pieces> P_pieces, Q_pieces;
+  if (strategy != MINKOWSKI_REDUCED_CONVOLUTION) {
+    P_pieces.resize(P.size());
+    Q_pieces.resize(Q.size());
+    // The decomposition is the conversion to the representation the sums work on
+    parallel_for(P.size(), [&](size_t i) {
+      Phase_timer timer(PHASE_CONVERT);
+      P_pieces[i] = convex_decomposition(P[i], strategy);
+    });
+    parallel_for(Q.size(), [&](size_t i) {
+      Phase_timer timer(PHASE_CONVERT);
+      Q_pieces[i] = convex_decomposition(Q[i], strategy);
+    });
   }
+  for (size_t i = 0; i < P.size(); ++i) P_convex[i] = !P[i].is_na() && is_convex_polygon(P[i]);
+  for (size_t i = 0; i < Q.size(); ++i) Q_convex[i] = !Q[i].is_na() && is_convex_polygon(Q[i]);
+
+  parallel_for(max_size, [&](size_t i) {
+    size_t i_p = i % P.size(), i_q = i % Q.size();
+    if (P[i_p].is_na() || Q[i_q].is_na()) {
+      res[i] = Polygon::NA_value();
+      return;
+    }
+    Phase_timer timer(PHASE_ALGORITHM);
+    if (P_convex[i_p] && Q_convex[i_q]) {
+      res[i] = Polygon(convex_minkowski_sum(P[i_p].outer_boundary(), Q[i_q].outer_boundary()));
+    } else if (strategy == MINKOWSKI_REDUCED_CONVOLUTION) {
+      res[i] = CGAL::minkowski_sum_2(P[i_p], Q[i_q]);
+    } else {
+      res[i] = minkowski_sum_decomposed(P_pieces[i_p], Q_pieces[i_q]);
+    }
+  });
 
+  finalize_output(res);
+  Phase_timer output(PHASE_OUTPUT, res.size());
   return polyclid::create_polygon_vec(res);
 }
@@ -0,0 +1,69 @@
+#include <vector>
+#include <algorithm>
+
+#include <cpp11/declarations.hpp>
+#include <cpp11/integers.hpp>
+#include <cpp11/doubles.hpp>
+#include <cpp11/list.hpp>
+
+#include <euclid.h>
+#include <polyclid.h>
+
+#include "coords.h"
+#include "parallel.h"
+#include "profile.h"
+
+// Reflex vertices have the interior on their outside. Valid polygons have a
+// counterclockwise boundary and clockwise holes so the interior is always to
+// the left and reflex vertices are right turns
+template<typename Ring>
+int count_reflex(const Ring& ring) {
+  Coords c = extract_coords(ring);
+  size_t n = c.size();
+  int reflex = 0;
+  for (size_t i = 0; i < n; ++i) {
+    size_t prev = i == 0 ? n - 1 : i - 1;
+    size_t next = i == n - 1 ? 0 : i + 1;
+    double cross = (c.x[i] - c.x[prev]) * (c.y[next] - c.y[i]) - (c.y[i] - c.y[prev]) * (c.x[next] - c.x[i]);
+    if (cross < 0) reflex++;
+  }
+  return reflex;
+}
+
+// The statistics used by offset_poly() to estimate the cost of the offset engines
+[[cpp11::register]]
+cpp11::writable::list polygon_offset_stats(SEXP polygons) {
+  Profile_scope profile("polygon_offset_stats");
+  Phase_timer input(PHASE_INPUT);
+  std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
+  size_t n = poly.size();
+  input.stop(n);
+  std::vector<int> vertices(n, NA_INTEGER), holes(n, NA_INTEGER), reflex(n, NA_INTEGER);
+  std::vector<double> extent(n, NA_REAL);
+
+  parallel_for(n, [&](size_t i) {
+    if (poly[i].is_na() || poly[i].is_unbounded()) {
+      return;
+    }
+    Phase_timer timer(PHASE_ALGORITHM);
+    const Polygon& p = poly[i];
+    vertices[i] = p.outer_boundary().size();
+    holes[i] = p.number_of_holes();
+    reflex[i] = count_reflex(p.outer_boundary());
+    for (auto iter = p.holes_begin(); iter != p.holes_end(); iter++) {
+      vertices[i] += iter->size();
+      reflex[i] += count_reflex(*iter);
+    }
+    CGAL::Bbox_2 bbox = p.outer_boundary().bbox();
+    extent[i] = std::min(bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin());
+  });
+
+  Phase_timer output(PHASE_OUTPUT, n);
+  using namespace cpp11::literals;
+  return cpp11::writable::list({
+    "vertices"_nm = cpp11::writable::integers(vertices.begin(), vertices.end()),
+    "holes"_nm = cpp11::writable::integers(holes.begin(), holes.end()),
+    "reflex"_nm = cpp11::writable::integers(reflex.begin(), reflex.end()),
+    "extent"_nm = cpp11::writable::doubles(extent.begin(), extent.end())
+  });
+}
@@ -0,0 +1,18 @@
+#include <cpp11/declarations.hpp>
+
+#include "output.h"
+
+static Output_policy output_policy = OUTPUT_LAZY;
+
+Output_policy get_output_policy() {
+  return output_policy;
+}
+
+[[cpp11::register]]
+int set_output_policy(int policy) {
+  int old = output_policy;
+  if (policy >= OUTPUT_LAZY && policy <= OUTPUT_DOUBLE) {
+    output_policy = static_cast<Output_policy>(policy);
+  }
+  return old;
+}
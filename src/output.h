@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <iterator>
+
+#include <CGAL/Boolean_set_operations_2.h>
+
+#include <euclid.h>
+#include <polyclid.h>
+
+#include "parallel.h"
+#include "profile.h"
+
+// How constructed geometries are prepared before being returned to R
+enum Output_policy {
+  OUTPUT_LAZY = 0,   // Returned with their full construction history
+  OUTPUT_EXACT = 1,  // Exactly evaluated so the construction history is freed
+  OUTPUT_DOUBLE = 2  // Rounded to the nearest double coordinates
+};
+
+Output_policy get_output_policy();
+
+inline Point_2 finalize_point(const Point_2& p, Output_policy policy) {
+  if (policy == OUTPUT_DOUBLE) {
+    return Point_2(CGAL::to_double(p.x()), CGAL::to_double(p.y()));
+  }
+  if (policy == OUTPUT_EXACT) {
+    // Evaluating the exact value prunes the lazy DAG of the point
+    p.exact();
+  }
+  return p;
+}
+
+// Works for both polygon rings and polylines
+template<typename Ring>
+Ring finalize_ring(const Ring& ring, Output_policy policy) {
+  std::vector<Point_2> points;
+  for (auto iter = ring.vertices_begin(); iter != ring.vertices_end(); iter++) {
+    points.push_back(finalize_point(*iter, policy));
+  }
+  return {points.begin(), points.end()};
+}
+
+template<typename PWH>
+PWH finalize_polygon(const PWH& poly, Output_policy policy) {
+  PWH res;
+  if (!poly.is_unbounded()) {
+    res = PWH(finalize_ring(poly.outer_boundary(), policy));
+  }
+  for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
+    res.add_hole(finalize_ring(*iter, policy));
+  }
+  return res;
+}
+
+inline Polygon finalize_geometry(const Polygon& poly, Output_policy policy) {
+  return finalize_polygon(poly, policy);
+}
+inline Polyline finalize_geometry(const Polyline& line, Output_policy policy) {
+  return finalize_ring(line, policy);
+}
+// The arrangement of a polygon set also holds the supporting lines of its
+// edges so the set is rebuilt from its finalized polygons. Exact evaluation
+// leaves the polygons disjoint so they can be inserted as is. Rounding may make
+// a polygon self-intersecting, which join() does not accept, so such polygons
+// are evaluated exactly instead of being rounded. Rounding may also make
+// neighbouring polygons overlap so they are joined rather than inserted
+inline Polygon_set finalize_geometry(const Polygon_set& set, Output_policy policy) {
+  std::vector<Polygon_set::Polygon_with_holes_2> polygons;
+  set.polygons_with_holes(std::back_inserter(polygons));
+  Polygon_set res;
+  if (policy == OUTPUT_EXACT) {
+    for (auto& poly : polygons) {
+      poly = finalize_polygon(poly, policy);
+    }
+    res.insert(polygons.begin(), polygons.end());
+    return res;
+  }
+  Polygon_set::Traits_2 traits;
+  for (auto& poly : polygons) {
+    Polygon_set::Polygon_with_holes_2 rounded = finalize_polygon(poly, policy);
+    if (CGAL::is_valid_polygon_with_holes(rounded, traits)) {
+      poly = rounded;
+    } else {
+      poly = finalize_polygon(poly, OUTPUT_EXACT);
+    }
+  }
+  res.join(polygons.begin(), polygons.end());
+  return res;
+}
+
+// Applies the output policy set with boundaries_output() to a vector of
+// results. Should be called right before the results are converted to R
+template<typename T>
+void finalize_output(std::vector<T>& geometries) {
+  Output_policy policy = get_output_policy();
+  if (policy == OUTPUT_LAZY) {
+    return;
+  }
+  Phase_timer timer(PHASE_FINALIZE, geometries.size());
+  parallel_for(geometries.size(), [&](size_t i) {
+    if (geometries[i].is_na()) {
+      return;
+    }
+    geometries[i] = finalize_geometry(geometries[i], policy);
+  });
+}
@@ -0,0 +1,107 @@
+#include <condition_variable>
+#include <thread>
+
+#include <cpp11/declarations.hpp>
+
+#include <R_ext/Rdynload.h>
+#include <R_ext/Visibility.h>
+
+#include "parallel.h"
+
+static int n_threads = 1;
+
+int get_thread_count() {
+  return n_threads;
+}
+
+// Worker threads wait for a new generation of work and take part in it if
+// their id is below the number of workers requested for it. Only one task runs
+// at a time as parallel_for() is only entered from the main thread
+class Thread_pool {
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _start;
+  std::condition_variable _done;
+  const std::function<void()>* _task = nullptr;
+  size_t _n_active = 0;
+  size_t _running = 0;
+  size_t _generation = 0;
+  bool _stop = false;
+
+  void worker(size_t id, size_t seen) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      _start.wait(lock, [&]() { return _stop || _generation != seen; });
+      if (_stop) return;
+      seen = _generation;
+      if (id >= _n_active) continue;
+      const std::function<void()>* task = _task;
+      lock.unlock();
+      (*task)();
+      lock.lock();
+      if (--_running == 0) _done.notify_one();
+    }
+  }
+
+public:
+  ~Thread_pool() { shutdown(); }
+
+  void run(size_t n_workers, const std::function<void()>& task) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_workers.size() < n_workers) {
+      size_t id = _workers.size();
+      _workers.emplace_back(&Thread_pool::worker, this, id, _generation);
+    }
+    _task = &task;
+    _n_active = n_workers;
+    _running = n_workers;
+    _generation++;
+    lock.unlock();
+    _start.notify_all();
+    task();
+    lock.lock();
+    _done.wait(lock, [&]() { return _running == 0; });
+    _task = nullptr;
+  }
+
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _start.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+    _workers.clear();
+    _stop = false;
+  }
+};
+
+static Thread_pool& thread_pool() {
+  static Thread_pool pool;
+  return pool;
+}
+
+void run_on_pool(size_t n_workers, const std::function<void()>& task) {
+  thread_pool().run(n_workers, task);
+}
+
+// The workers must be stopped before the shared library is unloaded
+extern "C" attribute_visible void R_unload_boundaries(DllInfo* dll) {
+  thread_pool().shutdown();
+}
+
+[[cpp11::register]]
+int set_thread_count(int n) {
+  int old = n_threads;
+  if (n > 0) {
+    n_threads = n;
+  }
+  return old;
+}
+
+[[cpp11::register]]
+int hardware_thread_count() {
+  return std::thread::hardware_concurrency();
+}
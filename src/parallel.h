@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+#include "profile.h"
+
+int get_thread_count();
+
+// Runs `task` on `n_workers` threads of a pool that is kept alive between
+// calls, as well as on the calling thread, and returns once all of them are
+// done. Workers are started the first time they are needed
+void run_on_pool(size_t n_workers, const std::function<void()>& task);
+
+// The number of edges handed to a thread at a time when the work on a single
+// ring or line is split up
+const size_t RING_CHUNK_SIZE = 4096;
+
+inline bool& in_parallel_region() {
+  static thread_local bool in_region = false;
+  return in_region;
+}
+
+// Calls `fun(i)` for every i in [0, n) using the number of threads set with
+// boundaries_threads(). The work is run on a persistent pool of threads so
+// repeated calls do not pay for starting threads. Threads repeatedly claim the
+// next `grain` indices from a shared counter so threads that finish early take
+// over the remaining work. The calling thread takes part in the work, and
+// calls made from inside a parallel region are run serially. `fun` must never
+// call into R. The first exception thrown by `fun` is rethrown on the calling
+// thread after all threads have stopped
+template<typename F>
+void parallel_for(size_t n, F fun, size_t grain = 1) {
+  size_t n_threads = std::min<size_t>(get_thread_count(), (n + grain - 1) / grain);
+  if (n_threads < 2 || in_parallel_region()) {
+    for (size_t i = 0; i < n; ++i) {
+      fun(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&]() {
+    in_parallel_region() = true;
+    while (!failed) {
+      size_t start = next.fetch_add(grain);
+      if (start >= n) break;
+      size_t end = std::min(start + grain, n);
+      try {
+        for (size_t i = start; i < end; ++i) {
+          fun(i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        failed = true;
+      }
+    }
+    in_parallel_region() = false;
+  };
+
+  {
+    Profile_region profile;
+    run_on_pool(n_threads - 1, work);
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
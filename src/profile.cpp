@@ -0,0 +1,183 @@
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <cpp11/declarations.hpp>
+#include <cpp11/doubles.hpp>
+#include <cpp11/integers.hpp>
+#include <cpp11/list.hpp>
+#include <cpp11/strings.hpp>
+
+#include "profile.h"
+#include "memory.h"
+#include "parallel.h"
+
+static const char* phase_names[N_PROFILE_PHASES] = {
+  "input", "convert", "algorithm", "convert back", "finalize", "output"
+};
+
+struct Profile_record {
+  int call;
+  std::string entry;
+  std::string phase;
+  double time;
+  double cpu_time;
+  double count;
+  // Allocation counts and bytes of each allocator. NA if not tracked
+  double alloc_count[N_ALLOC_SOURCES];
+  double alloc_bytes[N_ALLOC_SOURCES];
+  double alloc_peak[N_ALLOC_SOURCES];
+};
+
+// Times are in nanoseconds
+static std::atomic<long long> phase_time[N_PROFILE_PHASES];
+static std::atomic<long long> phase_cpu_time[N_PROFILE_PHASES];
+static std::atomic<size_t> phase_count[N_PROFILE_PHASES];
+static std::vector<Profile_record> profile_log;
+static int n_calls = 0;
+static int scope_depth = 0;
+
+void record_phase(Profile_phase phase, Profile_clock::duration time, size_t count) {
+  long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+  phase_cpu_time[phase] += ns;
+  if (!in_parallel_region()) {
+    phase_time[phase] += ns;
+  }
+  phase_count[phase] += count;
+}
+
+Profile_region::Profile_region() : _active(profiling_enabled() && current_phase() == N_PROFILE_PHASES) {
+  if (!_active) return;
+  for (int i = 0; i < N_PROFILE_PHASES; ++i) {
+    _cpu_start[i] = phase_cpu_time[i];
+  }
+  _start = Profile_clock::now();
+}
+
+Profile_region::~Profile_region() {
+  if (!_active) return;
+  long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Profile_clock::now() - _start).count();
+  long long cpu[N_PROFILE_PHASES];
+  double cpu_total = 0;
+  for (int i = 0; i < N_PROFILE_PHASES; ++i) {
+    cpu[i] = phase_cpu_time[i] - _cpu_start[i];
+    cpu_total += cpu[i];
+  }
+  if (cpu_total <= 0) return;
+  for (int i = 0; i < N_PROFILE_PHASES; ++i) {
+    phase_time[i] += static_cast<long long>(elapsed * (cpu[i] / cpu_total));
+  }
+}
+
+Profile_scope::Profile_scope(const char* entry) : _entry(entry), _active(profiling_enabled() && scope_depth == 0) {
+  scope_depth++;
+  if (!_active) return;
+  for (int i = 0; i < N_PROFILE_PHASES; ++i) {
+    phase_time[i] = 0;
+    phase_cpu_time[i] = 0;
+    phase_count[i] = 0;
+  }
+  reset_alloc_stats();
+  _start = Profile_clock::now();
+}
+
+Profile_scope::~Profile_scope() {
+  scope_depth--;
+  if (!_active) return;
+  double total = std::chrono::duration<double>(Profile_clock::now() - _start).count();
+  n_calls++;
+  Alloc_stats alloc[N_ALLOC_SOURCES];
+  for (int j = 0; j < N_ALLOC_SOURCES; ++j) {
+    alloc[j] = get_alloc_stats(static_cast<Alloc_source>(j));
+  }
+  for (int i = 0; i < N_PROFILE_PHASES; ++i) {
+    if (phase_count[i] == 0 && phase_cpu_time[i] == 0) continue;
+    Profile_record record = {n_calls, _entry, phase_names[i], phase_time[i] * 1e-9, phase_cpu_time[i] * 1e-9, double(phase_count[i])};
+    for (int j = 0; j < N_ALLOC_SOURCES; ++j) {
+      record.alloc_count[j] = alloc[j].tracked ? alloc[j].count[i] : NA_REAL;
+      record.alloc_bytes[j] = alloc[j].tracked ? alloc[j].bytes[i] : NA_REAL;
+      record.alloc_peak[j] = NA_REAL;
+    }
+    profile_log.push_back(record);
+  }
+  // The total includes allocations made outside of the timed phases
+  Profile_record record = {n_calls, _entry, "total", total, NA_REAL, NA_REAL};
+  for (int j = 0; j < N_ALLOC_SOURCES; ++j) {
+    double count = 0, bytes = 0;
+    for (int i = 0; i <= N_PROFILE_PHASES; ++i) {
+      count += alloc[j].count[i];
+      bytes += alloc[j].bytes[i];
+    }
+    record.alloc_count[j] = alloc[j].tracked ? count : NA_REAL;
+    record.alloc_bytes[j] = alloc[j].tracked ? bytes : NA_REAL;
+    record.alloc_peak[j] = alloc[j].tracked ? alloc[j].peak : NA_REAL;
+  }
+  profile_log.push_back(record);
+}
+
+[[cpp11::register]]
+bool set_profiling(int enable) {
+  bool old = profiling_enabled();
+  if (enable >= 0) {
+    profiling_enabled() = enable != 0;
+  }
+  return old;
+}
+
+[[cpp11::register]]
+bool set_memory_profiling(bool enable) {
+  set_heap_tracking(enable);
+  return set_gmp_tracking(enable);
+}
+
+[[cpp11::register]]
+cpp11::writable::list get_profile_log(bool reset) {
+  size_t n = profile_log.size();
+  cpp11::writable::integers call(n);
+  cpp11::writable::strings entry(n);
+  cpp11::writable::strings phase(n);
+  cpp11::writable::doubles time(n);
+  cpp11::writable::doubles cpu_time(n);
+  cpp11::writable::doubles count(n);
+  cpp11::writable::doubles gmp_allocations(n);
+  cpp11::writable::doubles gmp_bytes(n);
+  cpp11::writable::doubles gmp_peak(n);
+  cpp11::writable::doubles heap_allocations(n);
+  cpp11::writable::doubles heap_bytes(n);
+  cpp11::writable::doubles heap_peak(n);
+  for (size_t i = 0; i < n; ++i) {
+    const Profile_record& record = profile_log[i];
+    call[i] = record.call;
+    entry[i] = record.entry;
+    phase[i] = record.phase;
+    time[i] = record.time;
+    cpu_time[i] = record.cpu_time;
+    count[i] = record.count;
+    gmp_allocations[i] = record.alloc_count[ALLOC_GMP];
+    gmp_bytes[i] = record.alloc_bytes[ALLOC_GMP];
+    gmp_peak[i] = record.alloc_peak[ALLOC_GMP];
+    heap_allocations[i] = record.alloc_count[ALLOC_HEAP];
+    heap_bytes[i] = record.alloc_bytes[ALLOC_HEAP];
+    heap_peak[i] = record.alloc_peak[ALLOC_HEAP];
+  }
+  if (reset) {
+    profile_log.clear();
+    n_calls = 0;
+  }
+
+  using namespace cpp11::literals;
+  return cpp11::writable::list({
+    "call"_nm = call,
+    "entry"_nm = entry,
+    "phase"_nm = phase,
+    "time"_nm = time,
+    "cpu_time"_nm = cpu_time,
+    "count"_nm = count,
+    "gmp_allocations"_nm = gmp_allocations,
+    "gmp_bytes"_nm = gmp_bytes,
+    "gmp_peak"_nm = gmp_peak,
+    "heap_allocations"_nm = heap_allocations,
+    "heap_bytes"_nm = heap_bytes,
+    "heap_peak"_nm = heap_peak
+  });
+}
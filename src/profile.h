@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// The phases the time of a call is split into when profiling is enabled with
+// boundaries_profiling()
+enum Profile_phase {
+  PHASE_INPUT = 0,         // Reading the geometries from R
+  PHASE_CONVERT = 1,       // Converting exact geometries to the working kernel
+  PHASE_ALGORITHM = 2,     // The algorithm itself
+  PHASE_CONVERT_BACK = 3,  // Converting results back to exact linear geometries
+  PHASE_FINALIZE = 4,      // Applying the output policy
+  PHASE_OUTPUT = 5,        // Creating the R vectors of the results
+  N_PROFILE_PHASES = 6
+};
+
+typedef std::chrono::steady_clock Profile_clock;
+
+inline bool& profiling_enabled() {
+  static bool enabled = false;
+  return enabled;
+}
+
+// The phase the calling thread is timing, used to attribute allocations to
+// phases. N_PROFILE_PHASES when no phase is timed
+inline int& current_phase() {
+  static thread_local int phase = N_PROFILE_PHASES;
+  return phase;
+}
+
+// Adds time and a number of processed elements to a phase of the call being
+// profiled. The time is always added to the CPU time of the phase. Outside of
+// multithreaded parallel_for() regions it is also added to the wall time, while
+// inside them the wall time is assigned by Profile_region. Safe to call from
+// multiple threads
+void record_phase(Profile_phase phase, Profile_clock::duration time, size_t count);
+
+// Times a phase from construction until stop() is called or the timer goes out
+// of scope. next() ends the current phase and starts another with a single
+// clock reading. When profiling is disabled the timer never reads the clock.
+// Timers may be used inside parallel_for() in which case the CPU time of a
+// phase is summed over all threads
+class Phase_timer {
+  Profile_phase _phase;
+  size_t _count;
+  bool _running;
+  int _previous;
+  Profile_clock::time_point _start;
+
+public:
+  Phase_timer(Profile_phase phase, size_t count = 1) : _phase(phase), _count(count), _running(profiling_enabled()) {
+    if (!_running) return;
+    _previous = current_phase();
+    current_phase() = phase;
+    _start = Profile_clock::now();
+  }
+  ~Phase_timer() { stop(); }
+
+  void stop() {
+    if (!_running) return;
+    record_phase(_phase, Profile_clock::now() - _start, _count);
+    current_phase() = _previous;
+    _running = false;
+  }
+  // Stop and set the number of elements processed, e.g. when it is only known
+  // once the phase is done
+  void stop(size_t count) {
+    _count = count;
+    stop();
+  }
+  void next(Profile_phase phase, size_t count = 1) {
+    if (!_running) return;
+    Profile_clock::time_point now = Profile_clock::now();
+    record_phase(_phase, now - _start, _count);
+    current_phase() = phase;
+    _phase = phase;
+    _count = count;
+    _start = now;
+  }
+};
+
+// Marks the extent of a call to an entry point. The phases recorded while the
+// scope is alive are added to the profile log, along with the total wall time
+// of the call, once it ends. Only the outermost scope is recorded
+class Profile_scope {
+  const char* _entry;
+  bool _active;
+  Profile_clock::time_point _start;
+
+public:
+  Profile_scope(const char* entry);
+  ~Profile_scope();
+};
+
+// Marks a multithreaded parallel_for() region. The wall time of the region is
+// split between the phases timed inside it in proportion to their CPU time in
+// the region. If a timer on the calling thread already covers the region it
+// gets the wall time instead, so nothing is assigned
+class Profile_region {
+  bool _active;
+  long long _cpu_start[N_PROFILE_PHASES];
+  Profile_clock::time_point _start;
+
+public:
+  Profile_region();
+  ~Profile_region();
+};
@@ -0,0 +1,223 @@
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "rank.h"
+
+static const double inf = std::numeric_limits<double>::infinity();
+
+static double segment_distance2(const Coords& c, size_t i, size_t a, size_t b) {
+  double dx = c.x[b] - c.x[a];
+  double dy = c.y[b] - c.y[a];
+  double px = c.x[i] - c.x[a];
+  double py = c.y[i] - c.y[a];
+  double len2 = dx * dx + dy * dy;
+  if (len2 > 0) {
+    double t = std::min(1.0, std::max(0.0, (px * dx + py * dy) / len2));
+    px -= t * dx;
+    py -= t * dy;
+  }
+  return px * px + py * py;
+}
+
+static double triangle_area(const Coords& c, size_t prev, size_t i, size_t next) {
+  double ax = c.x[prev] - c.x[i];
+  double ay = c.y[prev] - c.y[i];
+  double bx = c.x[next] - c.x[i];
+  double by = c.y[next] - c.y[i];
+  return std::abs(ax * by - ay * bx) * 0.5;
+}
+
+struct Dp_span {
+  size_t first;
+  size_t last;
+  double parent;
+};
+
+// Douglas-Peucker using an explicit stack. Indices are taken modulo n so spans
+// of a ring may wrap around. The importance of a vertex is capped by the one of
+// the vertex that split its span, which keeps the costs monotone
+static void douglas_peucker(const Coords& c, std::vector<double>& importance, std::vector<Dp_span>& stack) {
+  size_t n = c.size();
+  while (!stack.empty()) {
+    Dp_span span = stack.back();
+    stack.pop_back();
+    if (span.last - span.first < 2) continue;
+    size_t a = span.first % n, b = span.last % n;
+    double max_dist = -1.0;
+    size_t max_i = span.first + 1;
+    for (size_t i = span.first + 1; i < span.last; ++i) {
+      double dist = segment_distance2(c, i % n, a, b);
+      if (dist > max_dist) {
+        max_dist = dist;
+        max_i = i;
+      }
+    }
+    double imp = std::min(max_dist, span.parent);
+    importance[max_i % n] = imp;
+    stack.push_back({span.first, max_i, imp});
+    stack.push_back({max_i, span.last, imp});
+  }
+}
+
+static std::vector<double> douglas_peucker_importance(const Coords& c, bool ring) {
+  size_t n = c.size();
+  std::vector<double> importance(n, inf);
+  std::vector<Dp_span> stack;
+  if (!ring) {
+    if (n > 2) stack.push_back({0, n - 1, inf});
+    douglas_peucker(c, importance, stack);
+    return importance;
+  }
+  if (n <= 3) return importance;
+  // Anchor the ring at the first vertex and the vertex furthest from it
+  size_t far = 1;
+  double far_dist = -1.0;
+  for (size_t i = 1; i < n; ++i) {
+    double dx = c.x[i] - c.x[0], dy = c.y[i] - c.y[0];
+    double dist = dx * dx + dy * dy;
+    if (dist > far_dist) {
+      far_dist = dist;
+      far = i;
+    }
+  }
+  stack.push_back({0, far, inf});
+  stack.push_back({far, n, inf});
+  douglas_peucker(c, importance, stack);
+  // A ring needs a third vertex to have an area. Use the most important one
+  size_t third = n;
+  for (size_t i = 0; i < n; ++i) {
+    if (i == 0 || i == far) continue;
+    if (third == n || importance[i] > importance[third]) third = i;
+  }
+  importance[third] = inf;
+  return importance;
+}
+
+struct Vw_entry {
+  double area;
+  size_t i;
+  size_t version;
+  bool operator>(const Vw_entry& other) const {
+    return area > other.area || (area == other.area && i > other.i);
+  }
+};
+
+static std::vector<double> visvalingam_importance(const Coords& c, bool ring) {
+  size_t n = c.size();
+  std::vector<double> importance(n, inf);
+  size_t min_n = ring ? 3 : 2;
+  if (n <= min_n) return importance;
+
+  std::vector<size_t> prev(n), next(n), version(n, 0);
+  for (size_t i = 0; i < n; ++i) {
+    prev[i] = i == 0 ? n - 1 : i - 1;
+    next[i] = i == n - 1 ? 0 : i + 1;
+  }
+  std::priority_queue<Vw_entry, std::vector<Vw_entry>, std::greater<Vw_entry> > heap;
+  for (size_t i = ring ? 0 : 1; i < (ring ? n : n - 1); ++i) {
+    heap.push({triangle_area(c, prev[i], i, next[i]), i, 0});
+  }
+
+  size_t remaining = n;
+  double last = 0.0;
+  while (remaining > min_n && !heap.empty()) {
+    Vw_entry e = heap.top();
+    heap.pop();
+    if (e.version != version[e.i]) continue;
+    last = std::max(last, e.area);
+    importance[e.i] = last;
+    version[e.i] = std::numeric_limits<size_t>::max();
+    size_t p = prev[e.i], nx = next[e.i];
+    next[p] = nx;
+    prev[nx] = p;
+    remaining--;
+    if (ring || p != 0) {
+      version[p]++;
+      heap.push({triangle_area(c, prev[p], p, next[p]), p, version[p]});
+    }
+    if (ring || nx != n - 1) {
+      version[nx]++;
+      heap.push({triangle_area(c, prev[nx], nx, next[nx]), nx, version[nx]});
+    }
+  }
+  return importance;
+}
+
+std::vector<double> vertex_importance(const Coords& coords, bool ring, Rank_method method) {
+  switch (method) {
+  case RANK_DOUGLAS_PEUCKER: return douglas_peucker_importance(coords, ring);
+  case RANK_VISVALINGAM: return visvalingam_importance(coords, ring);
+  }
+  return std::vector<double>(coords.size(), inf);
+}
+
+Vertex_rank rank_from_importance(const std::vector<double>& importance) {
+  size_t n = importance.size();
+  Vertex_rank rank;
+  rank.cost = importance;
+  rank.order.assign(n, NEVER_REMOVED);
+  std::vector<size_t> removed;
+  for (size_t i = 0; i < n; ++i) {
+    if (importance[i] != inf) removed.push_back(i);
+  }
+  std::sort(removed.begin(), removed.end(), [&](size_t a, size_t b) {
+    return importance[a] < importance[b] || (importance[a] == importance[b] && a > b);
+  });
+  for (size_t i = 0; i < removed.size(); ++i) {
+    rank.order[removed[i]] = i;
+  }
+  return rank;
+}
+
+std::vector<bool> keep_vertices(const Vertex_rank& rank, int stop, double threshold) {
+  size_t n = rank.cost.size();
+  std::vector<bool> keep(n, false);
+  if (stop == 0) {
+    for (size_t i = 0; i < n; ++i) {
+      keep[i] = rank.cost[i] > threshold;
+    }
+    return keep;
+  }
+  size_t k = stop == 1 ? std::floor(threshold * n) : threshold;
+  size_t n_remove = n > k ? n - k : 0;
+  for (size_t i = 0; i < n; ++i) {
+    keep[i] = rank.order[i] >= n_remove;
+  }
+  return keep;
+}
+
+std::vector<size_t> global_removal_counts(const std::vector<Vertex_rank>& ranks, size_t budget) {
+  size_t n = 0;
+  std::vector< std::vector<double> > costs(ranks.size());
+  for (size_t i = 0; i < ranks.size(); ++i) {
+    n += ranks[i].cost.size();
+    for (size_t j = 0; j < ranks[i].order.size(); ++j) {
+      size_t order = ranks[i].order[j];
+      if (order == NEVER_REMOVED) continue;
+      if (order >= costs[i].size()) costs[i].resize(order + 1, inf);
+      costs[i][order] = ranks[i].cost[j];
+    }
+  }
+  std::vector<size_t> removed(ranks.size(), 0);
+  size_t to_remove = n > budget ? n - budget : 0;
+
+  // The costs of each geometry are monotone in removal order so a queue with
+  // the next vertex of each geometry gives the globally cheapest vertex
+  typedef std::pair<double, size_t> Next_vertex;
+  std::priority_queue<Next_vertex, std::vector<Next_vertex>, std::greater<Next_vertex> > queue;
+  for (size_t i = 0; i < costs.size(); ++i) {
+    if (!costs[i].empty()) queue.emplace(costs[i][0], i);
+  }
+  while (to_remove > 0 && !queue.empty()) {
+    size_t i = queue.top().second;
+    queue.pop();
+    removed[i]++;
+    to_remove--;
+    if (removed[i] < costs[i].size()) queue.emplace(costs[i][removed[i]], i);
+  }
+  return removed;
+}
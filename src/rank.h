@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include "coords.h"
+
+enum Rank_method {
+  RANK_DOUGLAS_PEUCKER = 0,
+  RANK_VISVALINGAM = 1
+};
+
+// The cost of removing each vertex of a ring or line. Costs are made monotone
+// so that removing every vertex with a cost at or below a threshold gives the
+// same result as removing vertices one by one until the threshold is reached.
+// Vertices that must be kept (the end points of a line and three vertices of
+// a ring) get an infinite cost.
+//
+// For Douglas-Peucker the cost is the squared distance from the vertex to the
+// simplified edge at the time it is added. For Visvalingam-Whyatt it is the
+// area of the triangle formed with its neighbours at the time it is removed
+std::vector<double> vertex_importance(const Coords& coords, bool ring, Rank_method method);
+
+const size_t NEVER_REMOVED = std::numeric_limits<size_t>::max();
+
+// The removal cost and removal order of every vertex of a geometry, numbered
+// across all its rings. Costs are monotone in removal order. Vertices that are
+// never removed have an infinite cost and an order of NEVER_REMOVED
+struct Vertex_rank {
+  std::vector<double> cost;
+  std::vector<size_t> order;
+};
+
+// Derive the removal order from the output of vertex_importance(), removing
+// cheaper vertices first
+Vertex_rank rank_from_importance(const std::vector<double>& importance);
+
+// Which vertices to keep given their rank and a stop condition using the same
+// codes as poly_simplify()
+std::vector<bool> keep_vertices(const Vertex_rank& rank, int stop, double threshold);
+
+// The number of vertices to remove from each geometry so that all geometries
+// together keep `budget` vertices, always removing the cheapest remaining vertex
+// of any geometry first
+std::vector<size_t> global_removal_counts(const std::vector<Vertex_rank>& ranks, size_t budget);
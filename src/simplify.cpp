@@ -1,25 +1,40 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <map>
+#include <limits>
 
 #include <cpp11/declarations.hpp>
+#include <cpp11/doubles.hpp>
 #include <cpp11/integers.hpp>
+#include <cpp11/list.hpp>
 #include <cpp11/strings.hpp>
 
 #include <euclid.h>
 #include <polyclid.h>
 
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Constrained_triangulation_plus_2.h>
 #include <CGAL/Polyline_simplification_2/simplify.h>
 
+#include "inexact.h"
+#include "output.h"
+#include "parallel.h"
+#include "profile.h"
+#include "rank.h"
+
 namespace PS = CGAL::Polyline_simplification_2;
 
 #define HYBRID 0;
 #define SCALED 1;
 #define SQUARED 2;
+#define DOUGLAS_PEUCKER 3;
+#define VISVALINGAM 4;
 
 #define ABOVE_COST 0;
 #define BELOW_RATIO 1;
 #define BELOW_COUNT 2;
+#define BELOW_TOTAL_COUNT 3;
 
 template<typename T, typename C, typename S>
 T poly_simplify_cost_stop_impl(T& poly, C cost, S stop);
@@ -36,6 +51,18 @@ Polyline poly_simplify_cost_stop_impl(Polyline& poly, C cost, S stop) {
   return {res.begin(), res.end()};
 }
 
+template<typename C, typename S>
+I_Polygon poly_simplify_cost_stop_impl(I_Polygon& poly, C cost, S stop) {
+  return PS::simplify(poly, cost, stop);
+}
+
+template<typename C, typename S>
+std::vector<I_Kernel::Point_2> poly_simplify_cost_stop_impl(std::vector<I_Kernel::Point_2>& poly, C cost, S stop) {
+  std::vector<I_Kernel::Point_2> res;
+  PS::simplify(poly.begin(), poly.end(), cost, stop, std::back_inserter(res), false);
+  return res;
+}
+
 template<typename T, typename C>
 T poly_simplify_cost_impl(T& poly, C cost, int stop, double stop_par) {
   switch (stop) {
@@ -52,11 +79,218 @@ T poly_simplify_cost_impl(T& poly, C cost, int stop, double stop_par) {
   return poly;
 }
 
+// Geometries are split into their rings (outer boundary first) so that a
+// ranking of all their vertices can be calculated and applied in one go
+template<typename PWH>
+std::vector< std::vector<typename PWH::Polygon_2::Point_2> > geometry_rings(const PWH& poly) {
+  std::vector< std::vector<typename PWH::Polygon_2::Point_2> > rings;
+  if (!poly.is_unbounded()) {
+    rings.emplace_back(poly.outer_boundary().vertices_begin(), poly.outer_boundary().vertices_end());
+  }
+  for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
+    rings.emplace_back(iter->vertices_begin(), iter->vertices_end());
+  }
+  return rings;
+}
+template<typename Point>
+std::vector< std::vector<Point> > geometry_rings(const std::vector<Point>& line) {
+  return std::vector< std::vector<Point> >(1, line);
+}
+std::vector< std::vector<Point_2> > geometry_rings(const Polyline& line) {
+  return std::vector< std::vector<Point_2> >(1, std::vector<Point_2>(line.vertices_begin(), line.vertices_end()));
+}
+
+template<typename PWH>
+bool rings_closed(const PWH& poly) {
+  return true;
+}
+template<typename Point>
+bool rings_closed(const std::vector<Point>& line) {
+  return false;
+}
+bool rings_closed(const Polyline& line) {
+  return false;
+}
+
+template<typename PWH>
+PWH rings_to_geometry(const PWH& poly, const std::vector< std::vector<typename PWH::Polygon_2::Point_2> >& rings) {
+  typedef typename PWH::Polygon_2 Ring;
+  PWH res;
+  size_t i = 0;
+  if (!poly.is_unbounded()) {
+    res = PWH(Ring(rings[i].begin(), rings[i].end()));
+    i++;
+  }
+  for (; i < rings.size(); ++i) {
+    res.add_hole(Ring(rings[i].begin(), rings[i].end()));
+  }
+  return res;
+}
+template<typename Point>
+std::vector<Point> rings_to_geometry(const std::vector<Point>& line, const std::vector< std::vector<Point> >& rings) {
+  return rings[0];
+}
+Polyline rings_to_geometry(const Polyline& line, const std::vector< std::vector<Point_2> >& rings) {
+  return {rings[0].begin(), rings[0].end()};
+}
+
+// Removes the vertices not kept in place rather than copying the kept ones
+template<typename Point>
+void filter_rings(std::vector< std::vector<Point> >& rings, const std::vector<bool>& keep) {
+  size_t k = 0;
+  for (auto& ring : rings) {
+    size_t n = 0;
+    for (size_t j = 0; j < ring.size(); ++j) {
+      if (!keep[k++]) continue;
+      if (n != j) ring[n] = std::move(ring[j]);
+      n++;
+    }
+    ring.erase(ring.begin() + n, ring.end());
+  }
+}
+
+// Stop condition that never stops the simplification but records every vertex
+// considered for removal, along with its cost and the vertex count at the time
+template<typename Point>
+struct Removal_record {
+  std::vector<Point> points;
+  std::vector<double> costs;
+  std::vector<size_t> counts;
+};
+template<typename Point>
+class Stop_recording {
+public:
+  Stop_recording(Removal_record<Point>* record) : record(record) {}
+
+  template<typename CDT>
+  bool operator()(const CDT& ct, typename CDT::Vertex_handle v, double cost,
+                  std::size_t initial_count, std::size_t current_count) const {
+    record->points.push_back(v->point());
+    record->costs.push_back(cost);
+    record->counts.push_back(current_count);
+    return false;
+  }
+
+private:
+  Removal_record<Point>* record;
+};
+
+template<typename K, typename Itag = CGAL::Exact_predicates_tag>
+using Simplify_ct = CGAL::Constrained_triangulation_plus_2<
+  CGAL::Constrained_Delaunay_triangulation_2<K,
+    CGAL::Triangulation_data_structure_2< PS::Vertex_base_2<K>, CGAL::Constrained_triangulation_face_base_2<K> >,
+    Itag
+  >
+>;
+
+// Runs a full topology preserving simplification once and derives the rank of
+// every vertex from the order in which they were removed. A vertex considered
+// for removal was removed if the vertex count dropped before the next one was
+// considered. The costs are made monotone with a running maximum which gives the
+// same result for "above cost" as stopping the simplification at the threshold
+template<typename Point, typename C>
+Vertex_rank rank_rings_cgal(const std::vector< std::vector<Point> >& rings, bool closed, C cost) {
+  typedef typename CGAL::Kernel_traits<Point>::Kernel K;
+  Simplify_ct<K> ct;
+  std::map<Point, std::vector<size_t>, typename K::Less_xy_2> index;
+  size_t n = 0;
+  for (auto& ring : rings) {
+    for (auto& point : ring) {
+      index[point].push_back(n++);
+    }
+    if (ring.size() > 1) {
+      ct.insert_constraint(ring.begin(), ring.end(), closed);
+    }
+  }
+
+  Removal_record<Point> record;
+  PS::simplify(ct, cost, Stop_recording<Point>(&record));
+  size_t final_count = ct.number_of_vertices();
+
+  Vertex_rank rank;
+  rank.cost.assign(n, std::numeric_limits<double>::infinity());
+  rank.order.assign(n, NEVER_REMOVED);
+  double max_cost = 0.0;
+  size_t order = 0;
+  for (size_t i = 0; i < record.points.size(); ++i) {
+    size_t next_count = i + 1 < record.counts.size() ? record.counts[i + 1] : final_count;
+    if (next_count >= record.counts[i]) continue;
+    max_cost = std::max(max_cost, record.costs[i]);
+    auto match = index.find(record.points[i]);
+    if (match == index.end()) continue;
+    for (size_t j : match->second) {
+      rank.cost[j] = max_cost;
+      rank.order[j] = order;
+    }
+    order++;
+  }
+  return rank;
+}
+
+// Ranking by Douglas-Peucker or Visvalingam-Whyatt on the double coordinates.
+// Does not preserve topology but runs in linear memory
+template<typename Point>
+Vertex_rank rank_rings_double(const std::vector< std::vector<Point> >& rings, bool closed, Rank_method method) {
+  std::vector<double> importance;
+  for (auto& ring : rings) {
+    std::vector<double> ring_imp = vertex_importance(extract_coords(ring), closed, method);
+    importance.insert(importance.end(), ring_imp.begin(), ring_imp.end());
+  }
+  return rank_from_importance(importance);
+}
+
+template<typename Point>
+Vertex_rank rank_rings(const std::vector< std::vector<Point> >& rings, bool closed, int cost, double cost_par) {
+  typedef typename CGAL::Kernel_traits<Point>::Kernel::FT FT;
+  switch (cost) {
+    case 0: {
+      return rank_rings_cgal(rings, closed, PS::Hybrid_squared_distance_cost<FT>(cost_par));
+    }
+    case 1: {
+      return rank_rings_cgal(rings, closed, PS::Scaled_squared_distance_cost());
+    }
+    case 2: {
+      return rank_rings_cgal(rings, closed, PS::Squared_distance_cost());
+    }
+    case 3: {
+      return rank_rings_double(rings, closed, RANK_DOUGLAS_PEUCKER);
+    }
+    case 4: {
+      return rank_rings_double(rings, closed, RANK_VISVALINGAM);
+    }
+  }
+  return Vertex_rank();
+}
+
+// Rank the vertices of exact rings, optionally doing the ranking on a copy
+// rounded to double precision
+Vertex_rank rank_exact_rings(const std::vector< std::vector<Point_2> >& rings, bool closed, int cost, double cost_par, bool fast) {
+  if (!fast) {
+    return rank_rings(rings, closed, cost, cost_par);
+  }
+  static E_to_I converter;
+  std::vector< std::vector<I_Kernel::Point_2> > irings(rings.size());
+  for (size_t i = 0; i < rings.size(); ++i) {
+    for (auto& point : rings[i]) {
+      irings[i].push_back(converter(point));
+    }
+  }
+  return rank_rings(irings, closed, cost, cost_par);
+}
+
 template<typename T>
+T poly_rank_simplify_impl(const T& poly, int cost, int stop, double stop_par) {
+  auto rings = geometry_rings(poly);
+  Vertex_rank rank = rank_rings(rings, rings_closed(poly), cost, 0.0);
+  filter_rings(rings, keep_vertices(rank, stop, stop_par));
+  return rings_to_geometry(poly, rings);
+}
+
+template<typename FT, typename T>
 T poly_simplify_impl(T& poly, int cost, int stop, double cost_par, double stop_par) {
   switch (cost) {
     case 0: {
-      return poly_simplify_cost_impl(poly, PS::Hybrid_squared_distance_cost<Kernel::FT>(cost_par), stop, stop_par);
+      return poly_simplify_cost_impl(poly, PS::Hybrid_squared_distance_cost<FT>(cost_par), stop, stop_par);
     }
     case 1: {
       return poly_simplify_cost_impl(poly, PS::Scaled_squared_distance_cost(), stop, stop_par);
@@ -64,39 +298,63 @@ T poly_simplify_impl(T& poly, int cost, int stop, double cost_par, double stop_p
     case 2: {
       return poly_simplify_cost_impl(poly, PS::Squared_distance_cost(), stop, stop_par);
     }
+    case 3:
+    case 4: {
+      return poly_rank_simplify_impl(poly, cost, stop, stop_par);
+    }
   }
   return poly;
 }
 
-
-
 [[cpp11::register]]
-SEXP poly_simplify(SEXP poly, int cost, int stop, double cost_par, double stop_par) {
+SEXP poly_simplify(SEXP poly, int cost, int stop, double cost_par, double stop_par, bool fast) {
+  Profile_scope profile("poly_simplify");
+  Phase_timer input(PHASE_INPUT);
   switch(polyclid::get_geometry_type(poly)) {
     case polyclid::POLYGON: {
       std::vector<Polygon> p = polyclid::get_polygon_vec(poly);
-      std::vector<Polygon> res;
-      res.reserve(p.size());
-      for (size_t i = 0; i < p.size(); ++i) {
+      input.stop(p.size());
+      std::vector<Polygon> res(p.size());
+      parallel_for(p.size(), [&](size_t i) {
         if (p[i].is_na()) {
-          res.push_back(Polygon::NA_value());
+          res[i] = Polygon::NA_value();
+        } else if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          I_Polygon ip = exact_to_inexact_poly(p[i]);
+          timer.next(PHASE_ALGORITHM);
+          ip = poly_simplify_impl<I_Kernel::FT>(ip, cost, stop, cost_par, stop_par);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_poly(ip);
         } else {
-          res.push_back(poly_simplify_impl(p[i], cost, stop, cost_par, stop_par));
+          Phase_timer timer(PHASE_ALGORITHM);
+          res[i] = poly_simplify_impl<Kernel::FT>(p[i], cost, stop, cost_par, stop_par);
         }
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
       return polyclid::create_polygon_vec(res);
     }
     case polyclid::POLYLINE: {
       std::vector<Polyline> p = polyclid::get_polyline_vec(poly);
-      std::vector<Polyline> res;
-      res.reserve(p.size());
-      for (size_t i = 0; i < p.size(); ++i) {
+      input.stop(p.size());
+      std::vector<Polyline> res(p.size());
+      parallel_for(p.size(), [&](size_t i) {
         if (p[i].is_na()) {
-          res.push_back(Polyline::NA_value());
+          res[i] = Polyline::NA_value();
+        } else if (fast) {
+          Phase_timer timer(PHASE_CONVERT);
+          std::vector<I_Kernel::Point_2> ip = exact_to_inexact_line(p[i]);
+          timer.next(PHASE_ALGORITHM);
+          ip = poly_simplify_impl<I_Kernel::FT>(ip, cost, stop, cost_par, stop_par);
+          timer.next(PHASE_CONVERT_BACK);
+          res[i] = inexact_to_exact_line(ip);
         } else {
-          res.push_back(poly_simplify_impl(p[i], cost, stop, cost_par, stop_par));
+          Phase_timer timer(PHASE_ALGORITHM);
+          res[i] = poly_simplify_impl<Kernel::FT>(p[i], cost, stop, cost_par, stop_par);
         }
-      }
+      });
+      finalize_output(res);
+      Phase_timer output(PHASE_OUTPUT, res.size());
       return polyclid::create_polyline_vec(res);
 
     }
@@ -106,3 +364,280 @@ SEXP poly_simplify(SEXP poly, int cost, int stop, double cost_par, double stop_p
   }
   return R_NilValue;
 }
+
+// Simplifies the rings of a whole vector of geometries in a single constrained
+// triangulation. Boundaries shared between neighbouring geometries become
+// overlapping constraints which are simplified once, so the geometries stay
+// aligned. Geometries may cross each other since intersections are constructed
+template<typename Point, typename C, typename S>
+void simplify_shared_cost_stop_impl(std::vector< std::vector< std::vector<Point> > >& geometries, bool closed, C cost, S stop) {
+  typedef typename CGAL::Kernel_traits<Point>::Kernel K;
+  typedef Simplify_ct<K, CGAL::Exact_intersections_tag> CT;
+  CT ct;
+  std::vector< std::vector<typename CT::Constraint_id> > ids(geometries.size());
+  for (size_t i = 0; i < geometries.size(); ++i) {
+    for (auto& ring : geometries[i]) {
+      if (ring.size() > 1) {
+        ids[i].push_back(ct.insert_constraint(ring.begin(), ring.end(), closed));
+      }
+    }
+  }
+
+  PS::simplify(ct, cost, stop);
+
+  for (size_t i = 0; i < geometries.size(); ++i) {
+    size_t k = 0;
+    for (auto& ring : geometries[i]) {
+      if (ring.size() < 2) continue;
+      typename CT::Constraint_id id = ids[i][k++];
+      ring.assign(ct.points_in_constraint_begin(id), ct.points_in_constraint_end(id));
+      // Closed constraints repeat the first point at the end
+      if (closed && ring.size() > 1 && ring.front() == ring.back()) {
+        ring.pop_back();
+      }
+    }
+  }
+}
+
+template<typename Point, typename C>
+void simplify_shared_cost_impl(std::vector< std::vector< std::vector<Point> > >& geometries, bool closed, C cost, int stop, double stop_par) {
+  switch (stop) {
+    case 0: {
+      simplify_shared_cost_stop_impl(geometries, closed, cost, PS::Stop_above_cost_threshold(stop_par));
+      break;
+    }
+    case 1: {
+      simplify_shared_cost_stop_impl(geometries, closed, cost, PS::Stop_below_count_ratio_threshold(stop_par));
+      break;
+    }
+    case 2: {
+      simplify_shared_cost_stop_impl(geometries, closed, cost, PS::Stop_below_count_threshold(stop_par));
+      break;
+    }
+  }
+}
+
+template<typename Point>
+void simplify_shared_impl(std::vector< std::vector< std::vector<Point> > >& geometries, bool closed, int cost, int stop, double cost_par, double stop_par) {
+  typedef typename CGAL::Kernel_traits<Point>::Kernel::FT FT;
+  switch (cost) {
+    case 0: {
+      simplify_shared_cost_impl(geometries, closed, PS::Hybrid_squared_distance_cost<FT>(cost_par), stop, stop_par);
+      break;
+    }
+    case 1: {
+      simplify_shared_cost_impl(geometries, closed, PS::Scaled_squared_distance_cost(), stop, stop_par);
+      break;
+    }
+    case 2: {
+      simplify_shared_cost_impl(geometries, closed, PS::Squared_distance_cost(), stop, stop_par);
+      break;
+    }
+    default: {
+      cpp11::stop("Shared boundaries are only supported for the topology preserving costs");
+    }
+  }
+}
+
+template<typename From, typename To, typename Converter>
+std::vector< std::vector< std::vector<To> > > convert_geometry_rings(const std::vector< std::vector< std::vector<From> > >& geometries, const Converter& converter) {
+  std::vector< std::vector< std::vector<To> > > res(geometries.size());
+  for (size_t i = 0; i < geometries.size(); ++i) {
+    for (auto& ring : geometries[i]) {
+      res[i].emplace_back();
+      res[i].back().reserve(ring.size());
+      for (auto& point : ring) {
+        res[i].back().push_back(converter(point));
+      }
+    }
+  }
+  return res;
+}
+
+template<typename T>
+std::vector<T> simplify_shared(const std::vector<T>& geometries, int cost, int stop, double cost_par, double stop_par, bool fast) {
+  std::vector< std::vector< std::vector<Point_2> > > rings(geometries.size());
+  bool closed = true;
+  for (size_t i = 0; i < geometries.size(); ++i) {
+    if (geometries[i].is_na()) continue;
+    rings[i] = geometry_rings(geometries[i]);
+    closed = rings_closed(geometries[i]);
+  }
+  if (fast) {
+    E_to_I to_inexact;
+    I_to_E to_exact;
+    Phase_timer timer(PHASE_CONVERT, geometries.size());
+    auto irings = convert_geometry_rings<Point_2, I_Kernel::Point_2>(rings, to_inexact);
+    timer.next(PHASE_ALGORITHM, geometries.size());
+    simplify_shared_impl(irings, closed, cost, stop, cost_par, stop_par);
+    timer.next(PHASE_CONVERT_BACK, geometries.size());
+    rings = convert_geometry_rings<I_Kernel::Point_2, Point_2>(irings, to_exact);
+  } else {
+    Phase_timer timer(PHASE_ALGORITHM, geometries.size());
+    simplify_shared_impl(rings, closed, cost, stop, cost_par, stop_par);
+  }
+  std::vector<T> res(geometries.size());
+  for (size_t i = 0; i < geometries.size(); ++i) {
+    if (geometries[i].is_na()) {
+      res[i] = T::NA_value();
+    } else {
+      res[i] = rings_to_geometry(geometries[i], rings[i]);
+    }
+  }
+  finalize_output(res);
+  return res;
+}
+
+[[cpp11::register]]
+SEXP poly_simplify_shared(SEXP poly, int cost, int stop, double cost_par, double stop_par, bool fast) {
+  Profile_scope profile("poly_simplify_shared");
+  Phase_timer input(PHASE_INPUT);
+  switch(polyclid::get_geometry_type(poly)) {
+    case polyclid::POLYGON: {
+      std::vector<Polygon> p = polyclid::get_polygon_vec(poly);
+      input.stop(p.size());
+      std::vector<Polygon> res = simplify_shared(p, cost, stop, cost_par, stop_par, fast);
+      Phase_timer output(PHASE_OUTPUT, res.size());
+      return polyclid::create_polygon_vec(res);
+    }
+    case polyclid::POLYLINE: {
+      std::vector<Polyline> p = polyclid::get_polyline_vec(poly);
+      input.stop(p.size());
+      std::vector<Polyline> res = simplify_shared(p, cost, stop, cost_par, stop_par, fast);
+      Phase_timer output(PHASE_OUTPUT, res.size());
+      return polyclid::create_polyline_vec(res);
+    }
+    default: {
+      cpp11::stop("Don't know how to simplify the provided geometry");
+    }
+  }
+  return R_NilValue;
+}
+
+template<typename T>
+std::vector<Vertex_rank> rank_geometries(const std::vector<T>& geometries, int cost, double cost_par, bool fast) {
+  std::vector<Vertex_rank> ranks(geometries.size());
+  parallel_for(geometries.size(), [&](size_t i) {
+    if (geometries[i].is_na()) {
+      return;
+    }
+    Phase_timer timer(PHASE_ALGORITHM);
+    ranks[i] = rank_exact_rings(geometry_rings(geometries[i]), rings_closed(geometries[i]), cost, cost_par, fast);
+  });
+  return ranks;
+}
+
+// Applying a ranking is a single pass over the vertices, always keeping the
+// exact input vertices. A total count is converted to a count for each
+// geometry up front
+template<typename T>
+std::vector<T> apply_ranks(const std::vector<T>& geometries, const std::vector<Vertex_rank>& ranks, int stop, double stop_par) {
+  std::vector<size_t> removals;
+  if (stop == 3) {
+    removals = global_removal_counts(ranks, stop_par);
+  }
+  std::vector<T> res(geometries.size());
+  parallel_for(geometries.size(), [&](size_t i) {
+    if (geometries[i].is_na()) {
+      res[i] = T::NA_value();
+      return;
+    }
+    std::vector<bool> keep;
+    if (stop == 3) {
+      keep = keep_vertices(ranks[i], 2, ranks[i].cost.size() - removals[i]);
+    } else {
+      keep = keep_vertices(ranks[i], stop, stop_par);
+    }
+    Phase_timer timer(PHASE_ALGORITHM, 0);
+    auto rings = geometry_rings(geometries[i]);
+    filter_rings(rings, keep);
+    res[i] = rings_to_geometry(geometries[i], rings);
+  });
+  finalize_output(res);
+  return res;
+}
+
+[[cpp11::register]]
+cpp11::writable::list poly_simplify_rank(SEXP poly, int cost, double cost_par, bool fast) {
+  Profile_scope profile("poly_simplify_rank");
+  Phase_timer input(PHASE_INPUT);
+  std::vector<Vertex_rank> ranks;
+  switch(polyclid::get_geometry_type(poly)) {
+    case polyclid::POLYGON: {
+      std::vector<Polygon> p = polyclid::get_polygon_vec(poly);
+      input.stop(p.size());
+      ranks = rank_geometries(p, cost, cost_par, fast);
+      break;
+    }
+    case polyclid::POLYLINE: {
+      std::vector<Polyline> p = polyclid::get_polyline_vec(poly);
+      input.stop(p.size());
+      ranks = rank_geometries(p, cost, cost_par, fast);
+      break;
+    }
+    default: {
+      cpp11::stop("Don't know how to simplify the provided geometry");
+    }
+  }
+
+  Phase_timer output(PHASE_OUTPUT, ranks.size());
+  size_t n = 0;
+  for (auto& rank : ranks) n += rank.cost.size();
+  cpp11::writable::integers geometry(n);
+  cpp11::writable::integers vertex(n);
+  cpp11::writable::doubles cost_res(n);
+  cpp11::writable::integers order(n);
+  size_t k = 0;
+  for (size_t i = 0; i < ranks.size(); ++i) {
+    for (size_t j = 0; j < ranks[i].cost.size(); ++j) {
+      geometry[k] = i + 1;
+      vertex[k] = j + 1;
+      cost_res[k] = ranks[i].cost[j];
+      order[k] = ranks[i].order[j] == NEVER_REMOVED ? NA_INTEGER : ranks[i].order[j] + 1;
+      k++;
+    }
+  }
+
+  using namespace cpp11::literals;
+  return cpp11::writable::list({
+    "geometry"_nm = geometry,
+    "vertex"_nm = vertex,
+    "cost"_nm = cost_res,
+    "rank"_nm = order
+  });
+}
+
+[[cpp11::register]]
+cpp11::writable::list poly_simplify_levels(SEXP poly, int cost, int stop, double cost_par, cpp11::doubles stop_par, bool fast) {
+  Profile_scope profile("poly_simplify_levels");
+  Phase_timer input(PHASE_INPUT);
+  cpp11::writable::list res;
+  switch(polyclid::get_geometry_type(poly)) {
+    case polyclid::POLYGON: {
+      std::vector<Polygon> p = polyclid::get_polygon_vec(poly);
+      input.stop(p.size());
+      std::vector<Vertex_rank> ranks = rank_geometries(p, cost, cost_par, fast);
+      for (R_xlen_t i = 0; i < stop_par.size(); ++i) {
+        std::vector<Polygon> level = apply_ranks(p, ranks, stop, stop_par[i]);
+        Phase_timer output(PHASE_OUTPUT, level.size());
+        res.push_back(polyclid::create_polygon_vec(level));
+      }
+      break;
+    }
+    case polyclid::POLYLINE: {
+      std::vector<Polyline> p = polyclid::get_polyline_vec(poly);
+      input.stop(p.size());
+      std::vector<Vertex_rank> ranks = rank_geometries(p, cost, cost_par, fast);
+      for (R_xlen_t i = 0; i < stop_par.size(); ++i) {
+        std::vector<Polyline> level = apply_ranks(p, ranks, stop, stop_par[i]);
+        Phase_timer output(PHASE_OUTPUT, level.size());
+        res.push_back(polyclid::create_polyline_vec(level));
+      }
+      break;
+    }
+    default: {
+      cpp11::stop("Don't know how to simplify the provided geometry");
+    }
+  }
+  return res;
+}
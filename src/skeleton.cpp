@@ -1,121 +1,281 @@
 #include <vector>
 #include <algorithm>
+#include <queue>
+#include <cmath>
+#include <limits>
 
 #include <cpp11/declarations.hpp>
+#include <cpp11/integers.hpp>
+#include <cpp11/list.hpp>
+#include <cpp11/doubles.hpp>
+#include <cpp11/logicals.hpp>
+#include <cpp11/strings.hpp>
 
-#include <CGAL/create_offset_polygons_from_polygon_with_holes_2.h>
-#include <CGAL/create_straight_skeleton_from_polygon_with_holes_2.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Cartesian_converter.h>
-
-#include <euclid.h>
-#include <polyclid.h>
-
-#include <boost/shared_ptr.hpp>
-
-typedef CGAL::Exact_predicates_inexact_constructions_kernel I_Kernel;
-typedef CGAL::Cartesian_converter<I_Kernel,Kernel> I_to_E;
-typedef CGAL::Cartesian_converter<Kernel,I_Kernel> E_to_I;
-typedef CGAL::Polygon_with_holes_2<I_Kernel> I_Polygon;
-
-I_Polygon exact_to_inexact_poly(const Polygon& poly) {
-  static E_to_I converter;
-  I_Polygon ipoly;
-  std::vector<I_Kernel::Point_2> ring;
-  if (!poly.is_unbounded()) {
-    std::transform(poly.outer_boundary().vertices_begin(), poly.outer_boundary().vertices_end(),
-                   std::back_inserter(ring),
-                   [](const Point_2& p) { return converter(p); });
-    ipoly = I_Polygon(CGAL::Polygon_2<I_Kernel>(ring.begin(), ring.end()));
-  }
+#include "skeleton.h"
+#include "output.h"
+#include "parallel.h"
+#include "profile.h"
+
+// Signed distance from a point to the boundary of a polygon. Positive inside
+double signed_boundary_distance(const I_Polygon& poly, double x, double y) {
+  bool inside = false;
+  double min_dist = std::numeric_limits<double>::infinity();
+  auto check_ring = [&](const CGAL::Polygon_2<I_Kernel>& ring) {
+    size_t n = ring.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+      double ax = ring[i].x(), ay = ring[i].y();
+      double bx = ring[j].x(), by = ring[j].y();
+      if ((ay > y) != (by > y) && x < (bx - ax) * (y - ay) / (by - ay) + ax) {
+        inside = !inside;
+      }
+      double dx = bx - ax, dy = by - ay;
+      double t = 0.0;
+      double len2 = dx * dx + dy * dy;
+      if (len2 > 0) {
+        t = std::min(1.0, std::max(0.0, ((x - ax) * dx + (y - ay) * dy) / len2));
+      }
+      double px = ax + t * dx - x, py = ay + t * dy - y;
+      min_dist = std::min(min_dist, px * px + py * py);
+    }
+  };
+  check_ring(poly.outer_boundary());
   for (auto iter = poly.holes_begin(); iter != poly.holes_end(); iter++) {
-    ring.clear();
-    std::transform(iter->vertices_begin(), iter->vertices_end(),
-                   std::back_inserter(ring),
-                   [](const Point_2& p) { return converter(p); });
-    ipoly.add_hole(CGAL::Polygon_2<I_Kernel>(ring.begin(), ring.end()));
+    check_ring(*iter);
   }
-  return ipoly;
+  return (inside ? 1.0 : -1.0) * std::sqrt(min_dist);
 }
-Polygon inexact_to_exact_poly(const I_Polygon& ipoly) {
-  static I_to_E converter;
-  Polygon poly;
-  std::vector<Point_2> ring;
-  if (!ipoly.is_unbounded()) {
-    std::transform(ipoly.outer_boundary().vertices_begin(), ipoly.outer_boundary().vertices_end(),
-                   std::back_inserter(ring),
-                   [](const I_Kernel::Point_2& p) { return converter(p); });
-    poly = Polygon(Segment_trait::Polygon_2(ring.begin(), ring.end()));
+
+struct Cell {
+  double x;
+  double y;
+  double h;
+  double d;
+  double max;
+  Cell(double x, double y, double h, const I_Polygon& poly) : x(x), y(y), h(h),
+    d(signed_boundary_distance(poly, x, y)), max(d + h * 1.4142135623730951) {}
+  bool operator<(const Cell& other) const { return max < other.max; }
+};
+
+// Upper bound of the radius of the largest inscribed circle found by quadtree
+// refinement of the bounding box (the pole of inaccessibility). Cells are only
+// discarded once no point inside them can be more than `tolerance` further
+// from the boundary than the best point found, so the largest possible
+// distance in any discarded cell bounds the radius from above while being at
+// most `tolerance` larger than it
+double inscribed_radius_bound(const I_Polygon& poly, double tolerance) {
+  CGAL::Bbox_2 bbox = poly.outer_boundary().bbox();
+  double width = bbox.xmax() - bbox.xmin();
+  double height = bbox.ymax() - bbox.ymin();
+  double cell_size = std::min(width, height);
+  if (cell_size == 0) return 0.0;
+  double h = cell_size / 2;
+
+  std::priority_queue<Cell> queue;
+  for (double x = bbox.xmin(); x < bbox.xmax(); x += cell_size) {
+    for (double y = bbox.ymin(); y < bbox.ymax(); y += cell_size) {
+      queue.emplace(x + h, y + h, h, poly);
+    }
   }
-  for (auto iter = ipoly.holes_begin(); iter != ipoly.holes_end(); iter++) {
-    ring.clear();
-    std::transform(iter->vertices_begin(), iter->vertices_end(),
-                   std::back_inserter(ring),
-                   [](const I_Kernel::Point_2& p) { return converter(p); });
-    poly.add_hole(Segment_trait::Polygon_2(ring.begin(), ring.end()));
+  Cell best(bbox.xmin() + width / 2, bbox.ymin() + height / 2, 0, poly);
+  double bound = best.d;
+
+  while (!queue.empty()) {
+    Cell cell = queue.top();
+    queue.pop();
+    if (cell.d > best.d) best = cell;
+    if (cell.max - best.d <= tolerance) {
+      bound = std::max(bound, cell.max);
+      continue;
+    }
+    h = cell.h / 2;
+    queue.emplace(cell.x - h, cell.y - h, h, poly);
+    queue.emplace(cell.x + h, cell.y - h, h, poly);
+    queue.emplace(cell.x - h, cell.y + h, h, poly);
+    queue.emplace(cell.x + h, cell.y + h, h, poly);
   }
-  return poly;
+
+  return std::max(std::max(bound, best.d), 0.0);
 }
 
 [[cpp11::register]]
-SEXP polygon_skeleton_offset(SEXP polygons, SEXP offset) {
+SEXP polygon_skeleton_create(SEXP polygons) {
+  Profile_scope profile("polygon_skeleton_create");
+  Phase_timer input(PHASE_INPUT);
   std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
+  input.stop(poly.size());
+  Skeleton_vec* res = new Skeleton_vec();
+  Skeleton_ptr ptr(res);
+  res->reserve(poly.size());
+
+  Phase_timer convert(PHASE_CONVERT, poly.size());
+  for (size_t i = 0; i < poly.size(); ++i) {
+    res->emplace_back(poly[i]);
+  }
+  convert.stop();
+  parallel_for(res->size(), [&](size_t i) {
+    if (!(*res)[i].is_na() && !(*res)[i].is_unbounded()) {
+      Phase_timer timer(PHASE_ALGORITHM);
+      (*res)[i].interior();
+    }
+  });
+
+  return ptr;
+}
+
+[[cpp11::register]]
+int skeleton_length(SEXP skeletons) {
+  return get_skeleton_vec(skeletons).size();
+}
+
+[[cpp11::register]]
+cpp11::writable::strings skeleton_format(SEXP skeletons) {
+  const Skeleton_vec& skel = get_skeleton_vec(skeletons);
+  cpp11::writable::strings res;
+  res.reserve(skel.size());
+
+  for (size_t i = 0; i < skel.size(); ++i) {
+    if (skel[i].is_na()) {
+      res.push_back(NA_STRING);
+      continue;
+    }
+    if (!skel[i].has_skeleton()) {
+      res.push_back("<Unbounded straight skeleton>");
+      continue;
+    }
+    const Ss& s = skel[i].interior();
+    res.push_back("<Straight skeleton: " + std::to_string(s.size_of_vertices()) + " vertices, " + std::to_string(s.size_of_halfedges() / 2) + " edges>");
+  }
+
+  return res;
+}
+
+[[cpp11::register]]
+SEXP skeleton_subset(SEXP skeletons, cpp11::integers index) {
+  const Skeleton_vec& skel = get_skeleton_vec(skeletons);
+  Skeleton_vec* res = new Skeleton_vec();
+  Skeleton_ptr ptr(res);
+  res->reserve(index.size());
+
+  for (R_xlen_t i = 0; i < index.size(); ++i) {
+    int j = index[i];
+    if (j == NA_INTEGER || j < 1 || size_t(j) > skel.size()) {
+      cpp11::stop("Skeleton index out of bounds");
+    }
+    res->push_back(skel[j - 1]);
+  }
+
+  return ptr;
+}
+
+[[cpp11::register]]
+SEXP polygon_skeleton_offset(SEXP polygons, SEXP offset) {
+  Profile_scope profile("polygon_skeleton_offset");
+  Skeleton_view skel(polygons);
+  // Only geometries are counted
+  Phase_timer input(PHASE_INPUT, 0);
   std::vector<Exact_number> os = euclid::get_exact_numeric_vec(offset);
+  input.stop();
 
-  size_t max_size = std::max(poly.size(), os.size());
-  std::vector<Polygon_set> res;
-  res.reserve(max_size);
+  size_t max_size = std::max(skel.size(), os.size());
+  std::vector<Polygon_set> res(max_size);
 
   E_to_I converter;
 
-  for (size_t i = 0; i < max_size; ++i) {
-    Polygon p = poly[i % poly.size()];
-    Exact_number of = os[i % os.size()];
-    if (!(p.get_flag(VALIDITY_CHECKED) && p.get_flag(IS_VALID))) {
-      cpp11::stop("Input polygons must be valid");
+  parallel_for(max_size, [&](size_t i) {
+    const Skeleton& s = skel[i % skel.size()];
+    const Exact_number& of = os[i % os.size()];
+    if (s.is_na() || of.is_na()) {
+      res[i] = Polygon_set::NA_value();
+      return;
     }
-    if (p.is_na() || of.is_na()) {
-      res.push_back(Polygon_set::NA_value());
-      continue;
+    Phase_timer timer(PHASE_ALGORITHM);
+    Offset_polygons offset = s.offset(converter(of));
+    timer.next(PHASE_CONVERT_BACK);
+    for (auto iter = offset.begin(); iter != offset.end(); iter++) {
+      res[i].insert(inexact_to_exact_poly(*iter->get()));
     }
-    std::vector< boost::shared_ptr<I_Polygon> > offset;
-    if (of > 0) {
-      offset = CGAL::create_exterior_skeleton_and_offset_polygons_with_holes_2(converter(of), exact_to_inexact_poly(p));
-    } else {
-      offset = CGAL::create_interior_skeleton_and_offset_polygons_with_holes_2(converter(-of), exact_to_inexact_poly(p));
+  });
+
+  finalize_output(res);
+  Phase_timer output(PHASE_OUTPUT, res.size());
+  return polyclid::create_polygon_set_vec(res);
+}
+
+// Offset polygons are disjoint by construction so they can be returned as is,
+// together with the index of the element they came from, rather than being
+// inserted into a polygon set one by one
+[[cpp11::register]]
+cpp11::writable::list polygon_skeleton_offset_flat(SEXP polygons, SEXP offset) {
+  Profile_scope profile("polygon_skeleton_offset_flat");
+  Skeleton_view skel(polygons);
+  // Only geometries are counted
+  Phase_timer input(PHASE_INPUT, 0);
+  std::vector<Exact_number> os = euclid::get_exact_numeric_vec(offset);
+  input.stop();
+
+  size_t max_size = std::max(skel.size(), os.size());
+  std::vector< std::vector<Polygon> > parts(max_size);
+
+  E_to_I converter;
+
+  parallel_for(max_size, [&](size_t i) {
+    const Skeleton& s = skel[i % skel.size()];
+    const Exact_number& of = os[i % os.size()];
+    if (s.is_na() || of.is_na()) {
+      parts[i].push_back(Polygon::NA_value());
+      return;
     }
-    Polygon_set offsetted_polygon;
-    res.push_back(offsetted_polygon);
+    Phase_timer timer(PHASE_ALGORITHM);
+    Offset_polygons offset = s.offset(converter(of));
+    timer.next(PHASE_CONVERT_BACK, offset.size());
+    parts[i].reserve(offset.size());
     for (auto iter = offset.begin(); iter != offset.end(); iter++) {
-      res.back().insert(inexact_to_exact_poly(*iter->get()));
+      parts[i].push_back(inexact_to_exact_poly(*iter->get()));
+    }
+  });
+
+  size_t n = 0;
+  for (size_t i = 0; i < max_size; ++i) {
+    n += parts[i].size();
+  }
+  std::vector<Polygon> res;
+  res.reserve(n);
+  cpp11::writable::integers id(n);
+  size_t k = 0;
+  for (size_t i = 0; i < max_size; ++i) {
+    for (auto iter = parts[i].begin(); iter != parts[i].end(); iter++) {
+      res.push_back(std::move(*iter));
+      id[k++] = i + 1;
     }
   }
 
-  return polyclid::create_polygon_set_vec(res);
+  finalize_output(res);
+  Phase_timer output(PHASE_OUTPUT, res.size());
+  using namespace cpp11::literals;
+  return cpp11::writable::list({
+    "polygon"_nm = polyclid::create_polygon_vec(res),
+    "id"_nm = id
+  });
 }
 
 [[cpp11::register]]
 SEXP polygon_skeleton_polylineset(SEXP polygons, bool keep_boundary, bool only_inner) {
-  std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
-  std::vector<Polyline_set> res;
-  res.reserve(poly.size());
+  Profile_scope profile("polygon_skeleton_polylineset");
+  Skeleton_view skel(polygons);
+  std::vector<Polyline_set> res(skel.size());
 
   I_to_E converter;
 
-  for (size_t i = 0; i < poly.size(); ++i) {
-    Polygon p = poly[i];
-    if (!(p.get_flag(VALIDITY_CHECKED) && p.get_flag(IS_VALID))) {
-      cpp11::stop("Input polygons must be valid");
-    }
-    if (p.is_na() || p.is_unbounded()) {
-      res.push_back(Polyline_set::NA_value());
-      continue;
+  parallel_for(skel.size(), [&](size_t i) {
+    if (skel[i].is_na() || skel[i].is_unbounded()) {
+      res[i] = Polyline_set::NA_value();
+      return;
     }
 
-    boost::shared_ptr< CGAL::Straight_skeleton_2<I_Kernel> > skeleton = CGAL::create_interior_straight_skeleton_2(exact_to_inexact_poly(p));
-    Polyline_set skeleton_lines;
-    res.push_back(skeleton_lines);
-    for (auto iter = skeleton->halfedges_begin(); iter != skeleton->halfedges_end(); iter++) {
+    Phase_timer timer(PHASE_ALGORITHM);
+    const Ss& skeleton = skel[i].interior();
+    timer.next(PHASE_CONVERT_BACK);
+    for (auto iter = skeleton.halfedges_begin(); iter != skeleton.halfedges_end(); iter++) {
       if ((iter->id()%2)==0) {
         if (!keep_boundary && !iter->is_bisector()) {
           continue;
@@ -123,86 +283,213 @@ SEXP polygon_skeleton_polylineset(SEXP polygons, bool keep_boundary, bool only_i
         if (only_inner && !iter->is_inner_bisector()) {
           continue;
         }
-        res.back().insert_non_overlapping(Segment_2(converter(iter->vertex()->point()), converter(iter->opposite()->vertex()->point())));
+        res[i].insert_non_overlapping(Segment_2(converter(iter->vertex()->point()), converter(iter->opposite()->vertex()->point())));
       }
     }
-  }
+  });
 
+  Phase_timer output(PHASE_OUTPUT, res.size());
   return polyclid::create_polyline_set_vec(res);
 }
 
-[[cpp11::register]]
-SEXP polygon_skeleton_limit(SEXP polygons) {
-  std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
-  std::vector<Exact_number> res;
-  res.reserve(poly.size());
+struct Skeleton_graph {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> time;
+  std::vector<int> contour;
+  std::vector<int> from;
+  std::vector<int> to;
+  std::vector<int> bisector;
+  std::vector<int> inner;
+};
 
-  for (size_t i = 0; i < poly.size(); ++i) {
-    Polygon p = poly[i];
-    if (!(p.get_flag(VALIDITY_CHECKED) && p.get_flag(IS_VALID))) {
-      cpp11::stop("Input polygons must be valid");
+// Vertices are numbered by their position in the skeleton's vertex list,
+// starting at 1. Each pair of opposite halfedges gives one edge
+Skeleton_graph skeleton_graph(const Ss& skeleton) {
+  Skeleton_graph graph;
+  size_t n_vertices = skeleton.size_of_vertices();
+  graph.x.reserve(n_vertices);
+  graph.y.reserve(n_vertices);
+  graph.time.reserve(n_vertices);
+  graph.contour.reserve(n_vertices);
+  std::vector<int> row;
+  for (auto iter = skeleton.vertices_begin(); iter != skeleton.vertices_end(); iter++) {
+    size_t id = iter->id();
+    if (id >= row.size()) row.resize(id + 1, 0);
+    graph.x.push_back(iter->point().x());
+    graph.y.push_back(iter->point().y());
+    graph.time.push_back(iter->time());
+    graph.contour.push_back(iter->is_contour());
+    row[id] = graph.x.size();
+  }
+  size_t n_edges = skeleton.size_of_halfedges() / 2;
+  graph.from.reserve(n_edges);
+  graph.to.reserve(n_edges);
+  graph.bisector.reserve(n_edges);
+  graph.inner.reserve(n_edges);
+  for (auto iter = skeleton.halfedges_begin(); iter != skeleton.halfedges_end(); iter++) {
+    if ((iter->id()%2)==0) {
+      graph.from.push_back(row[iter->opposite()->vertex()->id()]);
+      graph.to.push_back(row[iter->vertex()->id()]);
+      graph.bisector.push_back(iter->is_bisector());
+      graph.inner.push_back(iter->is_inner_bisector());
     }
-    if (p.is_na() || p.is_unbounded()) {
-      res.push_back(Exact_number::NA_value());
-      continue;
+  }
+  return graph;
+}
+
+[[cpp11::register]]
+cpp11::writable::list polygon_skeleton_graph(SEXP polygons) {
+  Profile_scope profile("polygon_skeleton_graph");
+  Skeleton_view skel(polygons);
+  std::vector<Skeleton_graph> graphs(skel.size());
+
+  parallel_for(skel.size(), [&](size_t i) {
+    if (skel[i].is_na() || skel[i].is_unbounded()) {
+      return;
     }
+    Phase_timer timer(PHASE_ALGORITHM);
+    const Ss& skeleton = skel[i].interior();
+    timer.next(PHASE_CONVERT_BACK);
+    graphs[i] = skeleton_graph(skeleton);
+  });
 
-    boost::shared_ptr< CGAL::Straight_skeleton_2<I_Kernel> > skeleton = CGAL::create_interior_straight_skeleton_2(exact_to_inexact_poly(p));
-    auto max_time = skeleton->vertices_begin()->time();
-    for (auto iter = skeleton->vertices_begin(); iter != skeleton->vertices_end(); iter++) {
-      if (iter->is_skeleton() && iter->time() > max_time) {
-        max_time = iter->time();
-      }
+  Phase_timer output(PHASE_OUTPUT, graphs.size());
+  size_t n_vertices = 0, n_edges = 0;
+  for (auto& graph : graphs) {
+    n_vertices += graph.x.size();
+    n_edges += graph.from.size();
+  }
+  cpp11::writable::integers v_skeleton(n_vertices);
+  cpp11::writable::doubles x(n_vertices);
+  cpp11::writable::doubles y(n_vertices);
+  cpp11::writable::doubles time(n_vertices);
+  cpp11::writable::logicals contour(n_vertices);
+  cpp11::writable::integers e_skeleton(n_edges);
+  cpp11::writable::integers from(n_edges);
+  cpp11::writable::integers to(n_edges);
+  cpp11::writable::logicals bisector(n_edges);
+  cpp11::writable::logicals inner(n_edges);
+  size_t k = 0, l = 0;
+  for (size_t i = 0; i < graphs.size(); ++i) {
+    const Skeleton_graph& graph = graphs[i];
+    for (size_t j = 0; j < graph.x.size(); ++j) {
+      v_skeleton[k] = i + 1;
+      x[k] = graph.x[j];
+      y[k] = graph.y[j];
+      time[k] = graph.time[j];
+      contour[k] = graph.contour[j] != 0;
+      k++;
+    }
+    for (size_t j = 0; j < graph.from.size(); ++j) {
+      e_skeleton[l] = i + 1;
+      from[l] = graph.from[j];
+      to[l] = graph.to[j];
+      bisector[l] = graph.bisector[j] != 0;
+      inner[l] = graph.inner[j] != 0;
+      l++;
     }
-    res.push_back(max_time);
   }
 
+  using namespace cpp11::literals;
+  return cpp11::writable::list({
+    "vertices"_nm = cpp11::writable::list({
+      "skeleton"_nm = v_skeleton,
+      "x"_nm = x,
+      "y"_nm = y,
+      "time"_nm = time,
+      "contour"_nm = contour
+    }),
+    "edges"_nm = cpp11::writable::list({
+      "skeleton"_nm = e_skeleton,
+      "from"_nm = from,
+      "to"_nm = to,
+      "bisector"_nm = bisector,
+      "inner"_nm = inner
+    })
+  });
+}
+
+[[cpp11::register]]
+SEXP polygon_skeleton_limit(SEXP polygons) {
+  Profile_scope profile("polygon_skeleton_limit");
+  Skeleton_view skel(polygons);
+  std::vector<Exact_number> res(skel.size());
+
+  parallel_for(skel.size(), [&](size_t i) {
+    if (skel[i].is_na() || skel[i].is_unbounded()) {
+      res[i] = Exact_number::NA_value();
+      return;
+    }
+
+    Phase_timer timer(PHASE_ALGORITHM);
+    res[i] = skel[i].limit();
+  });
+
+  Phase_timer output(PHASE_OUTPUT, res.size());
   return euclid::create_exact_numeric_vec(res);
 }
 
+[[cpp11::register]]
+cpp11::writable::doubles polygon_inscribed_radius(SEXP polygons, double tolerance) {
+  Profile_scope profile("polygon_inscribed_radius");
+  Skeleton_view skel(polygons);
+  std::vector<double> res(skel.size());
+
+  parallel_for(skel.size(), [&](size_t i) {
+    if (skel[i].is_na() || skel[i].is_unbounded()) {
+      res[i] = NA_REAL;
+      return;
+    }
+
+    Phase_timer timer(PHASE_ALGORITHM);
+    res[i] = inscribed_radius_bound(skel[i].polygon(), tolerance);
+  });
+
+  Phase_timer output(PHASE_OUTPUT, res.size());
+  cpp11::writable::doubles radius(res.size());
+  for (size_t i = 0; i < res.size(); ++i) {
+    radius[i] = res[i];
+  }
+  return radius;
+}
+
 [[cpp11::register]]
 SEXP polygon_skeleton_limit_location(SEXP polygons) {
-  std::vector<Polygon> poly = polyclid::get_polygon_vec(polygons);
-  std::vector<Polyline_set> res;
-  res.reserve(poly.size());
+  Profile_scope profile("polygon_skeleton_limit_location");
+  Skeleton_view skel(polygons);
+  std::vector<Polyline_set> res(skel.size());
 
   I_to_E converter;
 
-  for (size_t i = 0; i < poly.size(); ++i) {
-    Polygon p = poly[i];
-    if (!(p.get_flag(VALIDITY_CHECKED) && p.get_flag(IS_VALID))) {
-      cpp11::stop("Input polygons must be valid");
-    }
-    if (p.is_na() || p.is_unbounded()) {
-      res.push_back(Polyline_set::NA_value());
-      continue;
+  parallel_for(skel.size(), [&](size_t i) {
+    if (skel[i].is_na() || skel[i].is_unbounded()) {
+      res[i] = Polyline_set::NA_value();
+      return;
     }
 
-    boost::shared_ptr< CGAL::Straight_skeleton_2<I_Kernel> > skeleton = CGAL::create_interior_straight_skeleton_2(exact_to_inexact_poly(p));
-    auto max_time = skeleton->vertices_begin()->time();
-    for (auto iter = skeleton->vertices_begin(); iter != skeleton->vertices_end(); iter++) {
-      if (iter->is_skeleton() && iter->time() > max_time) {
-        max_time = iter->time();
-      }
-    }
-    res.push_back(Polyline_set());
-    for (auto iter = skeleton->halfedges_begin(); iter != skeleton->halfedges_end(); iter++) {
+    Phase_timer timer(PHASE_ALGORITHM);
+    const Ss& skeleton = skel[i].interior();
+    double max_time = skel[i].limit();
+    timer.next(PHASE_CONVERT_BACK);
+    for (auto iter = skeleton.halfedges_begin(); iter != skeleton.halfedges_end(); iter++) {
       if ((iter->id()%2)==0 && iter->is_bisector()) {
         bool prim_include = iter->vertex()->time() == max_time;
         bool sec_include = iter->opposite()->vertex()->time() == max_time;
         if (prim_include && sec_include) {
-          res.back().insert_non_overlapping(Segment_2(converter(iter->vertex()->point()), converter(iter->opposite()->vertex()->point())));
+          res[i].insert_non_overlapping(Segment_2(converter(iter->vertex()->point()), converter(iter->opposite()->vertex()->point())));
         } else {
           if (prim_include) {
-            CGAL::insert_point(res.back(), converter(iter->vertex()->point()));
+            CGAL::insert_point(res[i], converter(iter->vertex()->point()));
           }
           if (sec_include) {
-            CGAL::insert_point(res.back(), converter(iter->opposite()->vertex()->point()));
+            CGAL::insert_point(res[i], converter(iter->opposite()->vertex()->point()));
           }
         }
       }
     }
-  }
+  });
 
+  Phase_timer output(PHASE_OUTPUT, res.size());
   return polyclid::create_polyline_set_vec(res);
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include <cpp11/declarations.hpp>
+#include <cpp11/external_pointer.hpp>
+
+#include <CGAL/create_offset_polygons_from_polygon_with_holes_2.h>
+#include <CGAL/create_straight_skeleton_from_polygon_with_holes_2.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "inexact.h"
+#include "profile.h"
+
+typedef CGAL::Straight_skeleton_2<I_Kernel> Ss;
+typedef std::vector< boost::shared_ptr<I_Polygon> > Offset_polygons;
+
+// A polygon along with its interior straight skeleton. The skeleton is only
+// constructed once it is first needed and then kept around so that any number
+// of insets, skeleton lines, and limits can be derived from it. Copies share
+// the underlying polygon, but only share the skeleton if it was constructed
+// before the copy was made. Otherwise each copy constructs its own. Insets only
+// use the stored skeleton if it has already been constructed as CGAL will
+// otherwise build a cheaper partial skeleton for the given offset
+class Skeleton {
+  boost::shared_ptr<I_Polygon> _polygon;
+  mutable boost::shared_ptr<Ss> _interior;
+  bool _na;
+  bool _unbounded;
+
+public:
+  Skeleton(const Polygon& poly) : _na(poly.is_na()), _unbounded(false) {
+    if (!(poly.get_flag(VALIDITY_CHECKED) && poly.get_flag(IS_VALID))) {
+      cpp11::stop("Input polygons must be valid");
+    }
+    if (_na) return;
+    _unbounded = poly.is_unbounded();
+    _polygon.reset(new I_Polygon(exact_to_inexact_poly(poly)));
+  }
+
+  bool is_na() const { return _na; }
+  bool is_unbounded() const { return _unbounded; }
+  bool has_skeleton() const { return _interior.get() != nullptr; }
+  const I_Polygon& polygon() const { return *_polygon; }
+
+  const Ss& interior() const {
+    if (!has_skeleton()) {
+      _interior = CGAL::create_interior_straight_skeleton_2(*_polygon);
+      if (!has_skeleton()) {
+        throw std::runtime_error("Failed to construct the straight skeleton");
+      }
+    }
+    return *_interior;
+  }
+
+  Offset_polygons offset(double of) const {
+    if (of > 0) {
+      return CGAL::create_exterior_skeleton_and_offset_polygons_with_holes_2(of, *_polygon);
+    }
+    if (!has_skeleton()) {
+      return CGAL::create_interior_skeleton_and_offset_polygons_with_holes_2(-of, *_polygon);
+    }
+    std::vector< boost::shared_ptr< CGAL::Polygon_2<I_Kernel> > > rings =
+      CGAL::create_offset_polygons_2< CGAL::Polygon_2<I_Kernel> >(-of, interior());
+    return CGAL::arrange_offset_polygons_2<I_Polygon>(rings);
+  }
+
+  double limit() const {
+    const Ss& skeleton = interior();
+    double max_time = skeleton.vertices_begin()->time();
+    for (auto iter = skeleton.vertices_begin(); iter != skeleton.vertices_end(); iter++) {
+      if (iter->is_skeleton() && iter->time() > max_time) {
+        max_time = iter->time();
+      }
+    }
+    return max_time;
+  }
+};
+
+typedef std::vector<Skeleton> Skeleton_vec;
+typedef cpp11::external_pointer<Skeleton_vec> Skeleton_ptr;
+
+inline bool is_skeleton_vec(SEXP x) {
+  return Rf_inherits(x, "boundaries_skeleton");
+}
+
+inline const Skeleton_vec& get_skeleton_vec(SEXP x) {
+  Skeleton_ptr ptr(x);
+  if (ptr.get() == nullptr) {
+    cpp11::stop("Skeleton data is no longer available. Skeletons cannot be saved and restored between sessions");
+  }
+  return *ptr;
+}
+
+// The skeletons of either a skeleton vector or a polygon vector. Stored
+// skeletons are read in place from the external pointer. For polygons the
+// skeletons are owned by the view and constructed lazily on first use. The
+// view must not outlive the R object it was created from
+class Skeleton_view {
+  Skeleton_vec _owned;
+  const Skeleton_vec* _skeletons;
+
+public:
+  Skeleton_view(SEXP x) : _skeletons(&_owned) {
+    Phase_timer input(PHASE_INPUT);
+    if (is_skeleton_vec(x)) {
+      _skeletons = &get_skeleton_vec(x);
+      input.stop(_skeletons->size());
+      return;
+    }
+    std::vector<Polygon> poly = polyclid::get_polygon_vec(x);
+    input.stop(poly.size());
+    Phase_timer convert(PHASE_CONVERT, poly.size());
+    _owned.reserve(poly.size());
+    for (size_t i = 0; i < poly.size(); ++i) {
+      _owned.emplace_back(poly[i]);
+    }
+  }
+  Skeleton_view(const Skeleton_view&) = delete;
+  Skeleton_view& operator=(const Skeleton_view&) = delete;
+
+  size_t size() const { return _skeletons->size(); }
+  const Skeleton& operator[](size_t i) const { return (*_skeletons)[i]; }
+};